@@ -0,0 +1,55 @@
+//
+//  ansi-color.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef ansi_color_hpp
+#define ansi_color_hpp
+
+#include <cstdint>
+#include <string>
+
+enum class ColorMode {
+    None,
+    Palette256, // xterm 256-colour palette, SGR 38;5
+    TrueColor   // 24-bit, SGR 38;2
+};
+
+// "256" or "truecolor", anything else is no colour
+ColorMode parse_color_mode(const std::string &value);
+
+// Cells with equal keys look the same, so they share one escape.
+// The low 32 bits are the foreground, the high 32 bits the background,
+// and 0 is the terminal's default colour in either half.
+using ColorKey = uint64_t;
+
+#define COLOR_KEY_PALETTE 0x01000000u
+#define COLOR_KEY_RGB 0x02000000u
+#define COLOR_KEY_BG_SHIFT 32
+#define TRUECOLOR_MASK 0xFC // Drop 2 bits per channel, invisible but lets more cells merge
+
+// RGB -> xterm 256 index, 5 bits per channel
+const uint8_t *xterm256_lut();
+
+// Foreground key of a colour
+inline uint32_t color_key(uint8_t r, uint8_t g, uint8_t b, ColorMode mode) {
+    if (mode == ColorMode::Palette256) {
+        return COLOR_KEY_PALETTE | xterm256_lut()[(r >> 3) << 10 | (g >> 3) << 5 | (b >> 3)];
+    }
+    if (mode == ColorMode::TrueColor) {
+        return COLOR_KEY_RGB | (r & TRUECOLOR_MASK) << 16 | (g & TRUECOLOR_MASK) << 8 | (b & TRUECOLOR_MASK);
+    }
+    return 0;
+}
+
+// Key of a cell with foreground `fg` and background `bg`, both from color_key()
+inline ColorKey color_key_pair(uint32_t fg, uint32_t bg) {
+    return static_cast<ColorKey>(bg) << COLOR_KEY_BG_SHIFT | fg;
+}
+
+// Append the SGR escapes that switch the colours from `from` to `to`, only for the halves that differ
+void append_color_change(std::string &out, ColorKey from, ColorKey to);
+
+#endif /* ansi_color_hpp */
@@ -0,0 +1,134 @@
+//
+//  audio-queue.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef audio_queue_hpp
+#define audio_queue_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#define AUDIO_QUEUE_SIZE (1024 * 128) // buffer, must be a power of two
+
+// Lock-free single-producer/single-consumer ring buffer between the audio decode
+// thread (producer) and the SDL audio callback (consumer).
+// Positions only ever grow; masking them with capacity - 1 gives the buffer offset.
+// A full queue puts the producer to sleep on a futex-backed atomic wait until the
+// callback has drained it below the low-water mark.
+struct AudioQueue {
+    uint8_t *data = nullptr;
+    uint64_t capacity = 0;
+    std::atomic<uint64_t> write_pos{0}; // Only advanced by the producer
+    std::atomic<uint64_t> read_pos{0};  // Only advanced by the consumer
+    std::atomic<uint64_t> flush_pos{0}; // Everything before this is dropped, set by the producer
+    uint64_t low_water_mark = 0;        // The waiting producer gets woken up below this fill level
+    std::atomic<bool> producer_waiting{false};
+    std::atomic<uint32_t> wake_seq{0};  // Bumped to wake the producer up
+    std::atomic<bool> closed{false};
+    double time_base = 0.0;             // Add time base for accurate timing
+
+    void init(uint64_t size) {
+        data = new uint8_t[size];
+        capacity = size;
+        low_water_mark = size / 2;
+        write_pos = 0;
+        read_pos = 0;
+        flush_pos = 0;
+        closed = false;
+    }
+
+    void destroy() {
+        delete[] data;
+        data = nullptr;
+        capacity = 0;
+    }
+
+    // Bytes still waiting to be played
+    uint64_t size() const {
+        uint64_t read = std::max(read_pos.load(std::memory_order_acquire), flush_pos.load(std::memory_order_acquire));
+        return write_pos.load(std::memory_order_acquire) - read;
+    }
+
+    // Producer side: room left for push(). A pending flush only frees its space
+    // once the consumer has applied it, since the consumer may still be reading there.
+    uint64_t free_space() const {
+        return capacity - (write_pos.load(std::memory_order_relaxed) - read_pos.load(std::memory_order_acquire));
+    }
+
+    // Producer side: append `len` bytes, fails without writing anything if they don't fit
+    bool push(const uint8_t *src, uint64_t len) {
+        if (len > free_space()) {
+            return false;
+        }
+        uint64_t write = write_pos.load(std::memory_order_relaxed);
+        uint64_t offset = write & (capacity - 1);
+        uint64_t first = std::min(len, capacity - offset);
+        memcpy(data + offset, src, first);
+        memcpy(data, src + first, len - first);
+        write_pos.store(write + len, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: sleep until `len` bytes fit. Returns false if they never will,
+    // or once the queue got closed or `quit` is set.
+    bool wait_for_space(uint64_t len, const std::atomic<bool> &quit) {
+        while (free_space() < len) {
+            if (len > capacity || closed || quit) {
+                return false;
+            }
+            // Announce the wait before the final check, so the consumer either
+            // sees us waiting or we see the space it has just freed
+            uint32_t seq = wake_seq.load();
+            producer_waiting.store(true);
+            if (free_space() < len && !closed && !quit) {
+                wake_seq.wait(seq);
+            }
+            producer_waiting.store(false);
+        }
+        return !closed && !quit;
+    }
+
+    // Wake up a waiting producer for good, e.g. on shutdown
+    void close() {
+        closed = true;
+        wake_seq.fetch_add(1);
+        wake_seq.notify_all();
+    }
+
+    // Producer side: drop everything queued so far
+    void flush() {
+        flush_pos.store(write_pos.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    // Consumer side: hand up to `len` queued bytes to consume(span, span_len, offset)
+    // as at most two contiguous spans. Never blocks, returns the number of bytes consumed.
+    template <typename Consume>
+    uint64_t pop(uint64_t len, Consume &&consume) {
+        uint64_t read = std::max(read_pos.load(std::memory_order_relaxed), flush_pos.load(std::memory_order_acquire));
+        uint64_t available = write_pos.load(std::memory_order_acquire) - read;
+        uint64_t count = std::min(len, available);
+        uint64_t offset = read & (capacity - 1);
+        uint64_t first = std::min(count, capacity - offset);
+        if (first > 0) {
+            consume(data + offset, first, uint64_t(0));
+        }
+        if (count > first) {
+            consume(data, count - first, first);
+        }
+        read_pos.store(read + count);
+
+        // Only wake the producer once there is a worthwhile amount of room
+        if (producer_waiting.load() && size() <= low_water_mark) {
+            wake_seq.fetch_add(1);
+            wake_seq.notify_one();
+        }
+        return count;
+    }
+};
+
+#endif /* audio_queue_hpp */
@@ -0,0 +1,143 @@
+//
+//  av-clock.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef av_clock_hpp
+#define av_clock_hpp
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// A few values written by one thread and read by others without locking (seqlock).
+// Readers never block the writer, they retry or give up if they raced with it.
+template <size_t N>
+class SeqLockSnapshot {
+  private:
+    std::atomic<uint32_t> seq{0};
+    std::atomic<double> values[N] = {};
+
+  public:
+    void store(const double (&in)[N]) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < N; ++i) {
+            values[i].store(in[i], std::memory_order_relaxed);
+        }
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    bool try_load(double (&out)[N], int attempts = 4) const {
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            uint32_t before = seq.load(std::memory_order_acquire);
+            for (size_t i = 0; i < N; ++i) {
+                out[i] = values[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(before & 1) && before == seq.load(std::memory_order_relaxed)) {
+                return before != 0; // Nothing stored yet
+            }
+        }
+        return false;
+    }
+};
+
+// Position of the audio that is actually being heard, derived from the bytes the
+// audio callback has consumed. Video frames are scheduled against it.
+class AudioClock {
+  private:
+    double bytes_per_second = 0.0;
+    std::atomic<uint32_t> generation{0}; // Bumped on every flush, older samples get ignored
+
+    // Producer side: byte position in the audio queue where a decoded pts is known exactly
+    SeqLockSnapshot<3> anchor; // {generation, byte position, pts}
+    bool anchored = false;
+    double expected_pts = 0.0;
+
+    // Consumer side: {generation, pts heard at callback time, callback time, pts of the last byte delivered}
+    SeqLockSnapshot<4> heard;
+
+  public:
+    void init(double bytes_per_second);
+
+    // Producer: `len` bytes stored at queue position `pos` hold audio starting at `pts` seconds
+    void on_push(uint64_t pos, uint64_t len, double pts);
+
+    // Producer: the queue got flushed, the clock is unknown until new audio is played
+    void reset();
+
+    // Audio callback: `count` bytes from queue position `pos` were handed to the device,
+    // which asked for `device_len` bytes, i.e. roughly one buffer of output latency
+    void on_consume(uint64_t pos, uint64_t count, uint64_t device_len);
+
+    // Current audio position in seconds, false while it is unknown
+    bool now(double &pts) const;
+};
+
+#define JITTER_BUCKET_SECONDS 0.00025 // Histogram resolution
+#define JITTER_BUCKETS 200              // Covers 50ms, anything later lands in the last bucket
+
+// Distribution of how far frames were presented from their deadline
+class JitterStats {
+  private:
+    uint64_t buckets[JITTER_BUCKETS] = {}; // Of the absolute error
+    uint64_t samples = 0;
+    double sum = 0.0;                      // Signed, early is negative
+    double worst = 0.0;
+
+  public:
+    void add(double error);
+
+    uint64_t count() const { return samples; }
+    double mean() const { return samples ? sum / samples : 0.0; }
+    double max() const { return worst; }
+    // Absolute error below which `fraction` of the samples fall, in seconds
+    double percentile(double fraction) const;
+};
+
+#define FRAME_SCHEDULER_MAX_DRIFT 0.5 // Seconds off schedule before the timeline is re-anchored
+
+// Wall-clock deadlines for video that is not synced to audio.
+// A frame is due at the anchor time plus its pts distance from the anchor frame,
+// so rounding never accumulates and variable frame rates follow their timestamps.
+class FrameScheduler {
+  private:
+    bool anchored = false;
+    double anchor_time = 0.0;
+    double anchor_pts = 0.0;
+    double last_deadline = 0.0;
+    double last_pts = NAN;
+    double duration;              // Of the last frame, from its timestamps
+    JitterStats stats;
+
+    void anchor(double pts, double now);
+
+  public:
+    explicit FrameScheduler(double nominal_duration) : duration(nominal_duration) {}
+
+    // Start a new timeline at the next frame, e.g. after a pause
+    void reset() { anchored = false; }
+
+    // Deadline (clock_seconds()) of the next frame, stays the same until it is presented.
+    // Frames without a timestamp (NAN) follow the previous one after a frame duration.
+    double deadline(double pts, double now);
+
+    // The frame with `pts` due at `deadline` is presented at `now`
+    void presented(double pts, double deadline, double now);
+
+    double frame_duration() const { return duration; }
+    const JitterStats &jitter() const { return stats; }
+};
+
+// Monotonic time in seconds
+double clock_seconds();
+
+// Sleep until clock_seconds() reaches `deadline`
+void sleep_until_seconds(double deadline);
+
+#endif /* av_clock_hpp */
@@ -0,0 +1,62 @@
+//
+//  band-pool.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef band_pool_hpp
+#define band_pool_hpp
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define BAND_POOL_MAX_WORKERS 7         // On top of the calling thread
+#define ROW_BANDS_MIN_CELLS (256 * 128) // Smaller frames are converted on the calling thread
+#define ROW_BANDS_MIN_ROWS 8            // Per band
+
+// Persistent worker threads that split the work of one frame into bands.
+// Participant i (the calling thread is 0) takes bands i, i + n, ..., and run()
+// waits for every worker, so no worker can lag behind into the next run.
+class BandPool {
+  private:
+    std::vector<std::thread> workers;
+    int participants;        // Workers plus the calling thread, fixed before any worker starts
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0; // Bumped per run() so every worker joins in
+    int finished = 0;        // Workers done with the current run
+    bool stopping = false;
+    const std::function<void(int)> *task = nullptr;
+    int total = 0;
+
+    void worker_loop(int index);
+
+  public:
+    explicit BandPool(int worker_count);
+    ~BandPool();
+
+    BandPool(const BandPool &) = delete;
+    BandPool &operator=(const BandPool &) = delete;
+
+    int size() const { return participants - 1; }
+
+    // Call task(band) for every band in [0, count), one run at a time
+    void run(int count, const std::function<void(int)> &task);
+};
+
+// Shared pool of the render thread, sized to the cores on first use
+BandPool &render_band_pool();
+
+// Bands to split a frame of `rows` rows and `cells` cells into, 1 if it is not worth it
+int row_band_count(int rows, int64_t cells);
+
+// Call fn(band, first_row, end_row) for each of the `bands` bands of `rows` rows, in parallel
+void for_each_row_band(int rows, int bands, const std::function<void(int, int, int)> &fn);
+
+#endif /* band_pool_hpp */
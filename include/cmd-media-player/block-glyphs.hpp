@@ -0,0 +1,56 @@
+//
+//  block-glyphs.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef block_glyphs_hpp
+#define block_glyphs_hpp
+
+#include <opencv2/opencv.hpp>
+
+#include "ansi-color.hpp"
+#include "frame-diff.hpp"
+
+// How pixels become cells: one pixel per ASCII glyph, two per half block
+// (U+2580, top pixel in the foreground and bottom one in the background),
+// 2x4 per Braille pattern (U+2800-U+28FF, one dot per pixel) or 4x8 per
+// ASCII glyph picked by shape (see glyph-atlas.hpp).
+enum class GlyphMode {
+    Ascii,
+    HalfBlock,
+    Braille,
+    Shape
+};
+
+// "half", "braille" or "shape", anything else is ASCII
+GlyphMode parse_glyph_mode(const std::string &value);
+
+// Pixels covered by one cell
+int glyph_mode_columns(GlyphMode mode);
+int glyph_mode_rows(GlyphMode mode);
+
+// Whether the cells are outside ASCII, which only the ANSI writer can output
+bool glyph_mode_is_unicode(GlyphMode mode);
+
+#define BLOCK_THRESHOLD 128 // Luma from which a half or a dot is lit without colour
+
+// Half block cell codes, blank is ' '
+#define HALF_BLOCK_UPPER 1
+#define HALF_BLOCK_LOWER 2
+#define HALF_BLOCK_FULL 3
+
+// UTF-8 of every cell code. Braille codes are the dot pattern XOR 0x20,
+// which makes the empty pattern the blank ' '.
+const GlyphEncoding &half_block_encoding();
+const GlyphEncoding &braille_encoding();
+
+// Fill a grid of image.cols / 1 x image.rows / 2 cells at `cells` (rows `stride` apart)
+// from a gray image, or from an RGB one with colour keys into `colors`
+void map_half_blocks(const cv::Mat &image, ColorMode mode, char *cells, ColorKey *colors, size_t stride);
+
+// Same with image.cols / 2 x image.rows / 4 Braille cells
+void map_braille(const cv::Mat &image, ColorMode mode, char *cells, ColorKey *colors, size_t stride);
+
+#endif /* block_glyphs_hpp */
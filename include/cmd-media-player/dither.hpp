@@ -0,0 +1,30 @@
+//
+//  dither.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef dither_hpp
+#define dither_hpp
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#define DITHER_PIPELINE_STEP 32 // Columns between the progress updates of an error diffusion row
+#define DITHER_PIPELINE_LAG 2   // Columns a row has to stay behind the row above it
+
+// Converters that trade glyph levels for patterns, so gradients do not band
+// with short charsets. Same signature as image_to_ascii, for -ct.
+
+// 4x4 Bayer threshold matrix, each pixel is nudged by up to half a glyph level
+void image_to_ascii_bayer(const cv::Mat &image, int pre_space, const char *asciiChars, std::string &asciiImage);
+
+// Error diffusion. Rows run in parallel on large frames, each one staying
+// DITHER_PIPELINE_LAG columns behind the row above so its error has arrived.
+void image_to_ascii_floyd_steinberg(const cv::Mat &image, int pre_space, const char *asciiChars,
+                                    std::string &asciiImage);
+void image_to_ascii_atkinson(const cv::Mat &image, int pre_space, const char *asciiChars, std::string &asciiImage);
+
+#endif /* dither_hpp */
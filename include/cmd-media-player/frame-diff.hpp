@@ -0,0 +1,112 @@
+//
+//  frame-diff.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef frame_diff_hpp
+#define frame_diff_hpp
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ansi-color.hpp"
+
+// Unchanged cells between two changed ones are rewritten rather than jumped over
+// when the gap is shorter than a cursor-addressing escape
+#define DIFF_MERGE_GAP 8
+
+// UTF-8 bytes of one cell code, for grids that are not plain ASCII
+struct GlyphBytes {
+    char bytes[4];
+    uint8_t length;
+};
+using GlyphEncoding = std::array<GlyphBytes, 256>;
+
+// Keeps the glyph grid that is on screen and reports only the runs of cells
+// that changed since the previous frame. In colour modes every cell also has
+// a colour key, and a cell counts as changed when either of them does.
+// Cells are ASCII glyphs, or codes into a GlyphEncoding for Unicode glyphs;
+// either way ' ' is a blank cell.
+class FrameDiff {
+  private:
+    int width = 0;
+    int height = 0;
+    std::vector<char> cells;    // Grid of the frame being drawn
+    std::vector<char> previous; // Grid currently on screen
+    std::vector<ColorKey> colors;          // Colour keys of `cells`, empty without colour
+    std::vector<ColorKey> previous_colors; // Colour keys of `previous`
+    const GlyphEncoding *encoding = nullptr; // Null when the cells are ASCII
+    bool colored = false;
+    bool repaint = true;
+
+    void reset(int width, int height, const GlyphEncoding *encoding);
+
+    bool changed(size_t index) const {
+        return cells[index] != previous[index] || (colored && colors[index] != previous_colors[index]);
+    }
+
+  public:
+    // Repaint every cell on the next frame, e.g. after a resize or when the screen got cleared
+    void invalidate() {
+        repaint = true;
+    }
+
+    // Lay out `screen` on a width x height grid. Line breaks move to the next row
+    // and lines longer than the width wrap, like they would in the terminal.
+    void load(const std::string &screen, int width, int height);
+
+    // Start a blank width x height grid of codes into `encoding` and return it to be
+    // filled in row by row. Use instead of load() for grids that are not ASCII text.
+    char *load_codes(int width, int height, const GlyphEncoding *encoding);
+
+    // Colour keys of the grid being loaded, all default colour, to be filled in by the caller
+    ColorKey *load_color_keys();
+
+    // Colour the non-blank cells covered by a packed RGB image whose top-left cell is
+    // (top, left). Call after load() for every frame that is drawn in colour.
+    void load_colors(const uint8_t *rgb, size_t stride, int image_width, int image_height,
+                     int top, int left, ColorMode mode);
+
+    // Call emit(row, col, text, colors, length) for every changed run, then mark the frame
+    // as drawn. `text` holds the cells as loaded, `colors` the colour key of each of them
+    // or null without colour.
+    template <typename Emit>
+    void for_each_change(Emit &&emit) {
+        for (int row = 0; row < height; ++row) {
+            const size_t row_start = static_cast<size_t>(row) * width;
+            const char *current = cells.data() + row_start;
+            const ColorKey *current_colors = colored ? colors.data() + row_start : nullptr;
+            int col = 0;
+            while (col < width) {
+                if (!repaint && !changed(row_start + col)) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                int last_changed = col;
+                for (col = start + 1; col < width; ++col) {
+                    if (repaint || changed(row_start + col)) {
+                        last_changed = col;
+                    } else if (col - last_changed > DIFF_MERGE_GAP) {
+                        break;
+                    }
+                }
+                emit(row, start, current + start, current_colors ? current_colors + start : nullptr,
+                     last_changed - start + 1);
+            }
+        }
+        previous.swap(cells);
+        previous_colors.swap(colors);
+        repaint = false;
+    }
+
+    // Append the changed runs to `out` as cursor-addressing escapes followed by the glyphs,
+    // with a colour escape wherever the colour differs from the glyph before it
+    void append_changes_as_ansi(std::string &out);
+};
+
+#endif /* frame_diff_hpp */
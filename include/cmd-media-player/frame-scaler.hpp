@@ -0,0 +1,51 @@
+//
+//  frame-scaler.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef frame_scaler_hpp
+#define frame_scaler_hpp
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+#include <opencv2/opencv.hpp>
+
+// Converts decoded frames of any pixel format straight to an 8-bit gray (or packed
+// RGB) image at the terminal cell grid in one libswscale pass.
+// Each SwsContext is only rebuilt when the source format or the target size changes.
+class FrameScaler {
+  private:
+    struct Conversion {
+        SwsContext *sws_ctx = nullptr;
+        int src_width = 0;
+        int src_height = 0;
+        int src_format = AV_PIX_FMT_NONE;
+        int dst_width = 0;
+        int dst_height = 0;
+        cv::Mat image; // Output buffer reused across frames
+    };
+    Conversion gray;
+    Conversion rgb;
+
+    static const cv::Mat &convert(Conversion &conversion, const AVFrame *frame, int width, int height,
+                                  AVPixelFormat format, int type);
+
+  public:
+    FrameScaler() = default;
+    FrameScaler(const FrameScaler &) = delete;
+    FrameScaler &operator=(const FrameScaler &) = delete;
+    ~FrameScaler();
+
+    // The returned image stays valid until the next call, it is empty if scaling is impossible
+    const cv::Mat &scale(const AVFrame *frame, int width, int height);
+
+    // Same as scale() but to packed 8-bit RGB, for the colour modes
+    const cv::Mat &scale_rgb(const AVFrame *frame, int width, int height);
+};
+
+#endif /* frame_scaler_hpp */
@@ -0,0 +1,39 @@
+//
+//  glyph-atlas.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef glyph_atlas_hpp
+#define glyph_atlas_hpp
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "ansi-color.hpp"
+#include "glyph-kernels.hpp"
+
+#define GLYPH_CELL_COLUMNS 4    // Samples per cell in shape matching, GLYPH_BLOCK_SIZE in all
+#define GLYPH_CELL_ROWS 8
+#define SHAPE_MIN_CONTRAST 64   // Flatter cells have no shape to match and get a density glyph
+
+// Rasterized shapes of the printable ASCII glyphs that can be told apart at 4x8,
+// ink at 255, one GLYPH_BLOCK_SIZE-byte template per glyph
+struct GlyphAtlas {
+    std::vector<char> glyphs;
+    std::vector<uint8_t> templates;
+};
+
+// Built once on first use
+const GlyphAtlas &glyph_atlas();
+
+// Fill image.cols / 4 x image.rows / 8 cells at `cells` (rows `stride` apart) with the glyph
+// whose shape matches each 4x8 block best, with dark pixels as ink like the charsets.
+// Blocks below SHAPE_MIN_CONTRAST take their glyph from `density` instead.
+// An RGB image also fills `colors` with the average colour of every non-blank cell.
+void map_shape_glyphs(const cv::Mat &image, ColorMode mode, const GlyphTable &density,
+                      char *cells, ColorKey *colors, size_t stride);
+
+#endif /* glyph_atlas_hpp */
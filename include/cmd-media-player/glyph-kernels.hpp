@@ -0,0 +1,51 @@
+//
+//  glyph-kernels.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef glyph_kernels_hpp
+#define glyph_kernels_hpp
+
+#include <array>
+#include <cstdint>
+
+#define GLYPH_TABLE_MAX_RUNS 16
+#define DITHER_PATTERN_SIZE 32 // Bytes per dither_row() pattern, a whole vector
+#define GLYPH_BLOCK_SIZE 32    // Samples of one cell in shape matching, 4x8
+
+// Pixel -> glyph mapping of one charset.
+// Besides the plain 256-entry table it keeps the runs of equal glyphs over 0-255,
+// which lets the vector kernels map 16/32 pixels at a time with a byte shuffle.
+struct GlyphTable {
+    std::array<char, 256> lut;
+    int runs;                                    // Number of glyph runs, vector kernels need <= 16
+    uint8_t run_glyphs[GLYPH_TABLE_MAX_RUNS];    // Glyph of each run
+    uint8_t run_starts[GLYPH_TABLE_MAX_RUNS];    // First pixel value of each run
+};
+
+void build_glyph_table(const std::array<char, 256> &lut, GlyphTable &table);
+
+// Write the glyph of each of the `count` pixels to `out`
+void map_row_to_glyphs(const uint8_t *pixels, int count, const GlyphTable &table, char *out);
+
+// Fold the pixels into the running `min_value`/`max_value`
+void min_max_pixels(const uint8_t *pixels, int count, uint8_t &min_value, uint8_t &max_value);
+
+// out = pixels + raise - lower, saturated. The two patterns repeat every DITHER_PATTERN_SIZE
+// pixels and their period must divide 16, so every vector sees them from the start.
+// At most one of them may be non-zero at a position, the vector kernels saturate each in turn.
+void dither_row(const uint8_t *pixels, int count, const uint8_t *raise, const uint8_t *lower, uint8_t *out);
+
+// Index of the one of `count` GLYPH_BLOCK_SIZE-byte templates with the smallest
+// sum of absolute differences to `block`
+int match_glyph_block(const uint8_t *block, const uint8_t *templates, int count);
+
+// Sum of |a[i] - b[i]| over `count` bytes, at most 2^25 of them (rows, not whole videos)
+uint64_t sum_abs_diff(const uint8_t *a, const uint8_t *b, int count);
+
+// Name of the kernel set picked for this CPU ("avx2", "sse4.1", "neon" or "scalar")
+const char *glyph_kernel_name();
+
+#endif /* glyph_kernels_hpp */
@@ -0,0 +1,52 @@
+//
+//  histogram-eq.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef histogram_eq_hpp
+#define histogram_eq_hpp
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#define EQ_CLIP_LOW 0.01   // Share of the darkest pixels that end up black
+#define EQ_CLIP_HIGH 0.99  // Pixels above this share end up white
+#define EQ_BIN_LIMIT 4.0   // Bins are capped at this many times the average, which limits the contrast gain
+#define EQ_SMOOTHING 0.1   // Weight of a new frame in the smoothed curve
+#define EQ_SCENE_CUT 0.5   // Histogram change (share of pixels that moved) that restarts the smoothing
+
+using PixelHistogram = std::array<uint32_t, 256>;
+
+void count_pixels(const uint8_t *pixels, int count, PixelHistogram &histogram);
+
+// Contrast-limited histogram equalization with clip points, smoothed over frames
+// so the brightness does not flicker. Restarts on a scene cut.
+class HistogramEqualizer {
+  private:
+    std::array<float, 256> curve = {};    // Smoothed pixel -> equalized value
+    std::array<float, 256> previous = {}; // Last histogram as shares of the frame
+    bool primed = false;
+
+  public:
+    bool ready() const { return primed; }
+    void reset() { primed = false; }
+
+    // Move the curve towards the equalization of `histogram`
+    void update(const PixelHistogram &histogram);
+
+    uint8_t value(int pixel) const { return static_cast<uint8_t>(curve[pixel] + 0.5f); }
+};
+
+// Glyphs from the equalized frame. The histogram is counted while mapping and
+// only shapes the curve of the next frames, so it needs no pass of its own.
+void image_to_ascii_equalized(const cv::Mat &image, int pre_space, const char *asciiChars, std::string &asciiImage);
+
+// Forget the curve of image_to_ascii_equalized, at the start of a playback and after a seek
+void reset_equalizer();
+
+#endif /* histogram_eq_hpp */
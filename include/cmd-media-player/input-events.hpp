@@ -0,0 +1,108 @@
+//
+//  input-events.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef input_events_hpp
+#define input_events_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#define INPUT_EVENT_QUEUE_SIZE 64 // Power of two
+#define INPUT_ESCAPE_TIMEOUT_MS 25 // How long to wait for the rest of an escape sequence
+
+enum class UserAction {
+    None,
+    Quit,
+    KeyLeft,
+    KeyRight,
+    KeyUp,
+    KeyDown,
+    KeyEqual,
+    KeyMinus,
+    KeySpace,
+    Resize
+};
+
+// Lock-free single-producer single-consumer queue of small events.
+// Positions grow monotonically and wrap with the unsigned type, so N has to be a power of two.
+template <typename T, size_t N>
+class EventQueue {
+  private:
+    static_assert((N & (N - 1)) == 0, "EventQueue size must be a power of two");
+    T items[N];
+    std::atomic<uint32_t> head{0}; // Next slot to read, written by the consumer
+    std::atomic<uint32_t> tail{0}; // Next slot to write, written by the producer
+
+  public:
+    // Returns false if the queue is full, the event is dropped then
+    bool try_push(T item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        items[t % N] = item;
+        tail.store(t + 1, std::memory_order_release);
+        tail.notify_one();
+        return true;
+    }
+
+    bool try_pop(T &item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[h % N];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Block until there is an event
+    T wait_pop() {
+        T item;
+        while (!try_pop(item)) {
+            tail.wait(head.load(std::memory_order_relaxed), std::memory_order_acquire);
+        }
+        return item;
+    }
+};
+
+using ActionQueue = EventQueue<UserAction, INPUT_EVENT_QUEUE_SIZE>;
+
+// Reads keys from stdin and terminal resizes (SIGWINCH) on its own thread and
+// posts them as actions. Keys are decoded from the raw bytes, so ncurses is
+// never called from this thread. While running it keeps the cached terminal
+// size up to date, so get_terminal_size() does not need an ioctl per call.
+class InputEventThread {
+  private:
+    std::thread thread;
+    int wake_pipe[2] = {-1, -1}; // Self-pipe, written from signal handlers
+    ActionQueue actions;
+
+    void run();
+
+  public:
+    InputEventThread() = default;
+    ~InputEventThread();
+
+    InputEventThread(const InputEventThread &) = delete;
+    InputEventThread &operator=(const InputEventThread &) = delete;
+
+    // Start reading stdin, call once the terminal is set up
+    bool start();
+    // Stop the thread and restore the SIGWINCH handler, stdin can be read directly afterwards
+    void stop();
+
+    bool try_pop(UserAction &action) { return actions.try_pop(action); }
+    UserAction wait_pop() { return actions.wait_pop(); }
+};
+
+// Make the input thread post a Quit action, safe to call from a signal handler
+void post_input_interrupt();
+
+#endif /* input_events_hpp */
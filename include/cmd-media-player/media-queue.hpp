@@ -0,0 +1,99 @@
+//
+//  media-queue.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef media_queue_hpp
+#define media_queue_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Bounded blocking queue connecting two pipeline stages.
+// The producer blocks while the queue is full (backpressure) and the consumer
+// blocks while it is empty, until the queue gets aborted on shutdown.
+template <typename T>
+class BoundedQueue {
+  private:
+    std::deque<T> items;
+    size_t capacity;
+    bool aborted = false;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+  public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    // Returns false if the queue was aborted before there was room for the item
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return aborted || items.size() < capacity; });
+        if (aborted) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Returns false if the queue was aborted
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return aborted || !items.empty(); });
+        if (aborted) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Returns false on timeout or abort
+    template <typename Rep, typename Period>
+    bool pop_for(T &item, const std::chrono::duration<Rep, Period> &timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!not_empty.wait_for(lock, timeout, [this] { return aborted || !items.empty(); }) || aborted) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Drop every queued item, handing each one to `release` first
+    template <typename Release>
+    void flush(Release release) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &item : items) {
+            release(item);
+        }
+        items.clear();
+        not_full.notify_all();
+    }
+
+    // Wake up every blocked producer and consumer; the queue stays unusable afterwards
+    void abort() {
+        std::lock_guard<std::mutex> lock(mutex);
+        aborted = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+};
+
+#endif /* media_queue_hpp */
@@ -43,6 +43,8 @@ extern const std::string VERSION; // Declare the version variable
 
 std::string format_time(int64_t seconds);
 void get_terminal_size(int &width, int &height);
+void enable_terminal_size_cache(bool enable); // Serve get_terminal_size() from the cache instead of an ioctl
+void update_terminal_size_cache();
 std::string get_system_type();
 void save_default_options_to_file(std::map<std::string, std::string> &default_options);
 void load_default_options_from_file(std::map<std::string, std::string> &default_options);
@@ -0,0 +1,24 @@
+//
+//  player-bench.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef player_bench_hpp
+#define player_bench_hpp
+
+#include <map>
+#include <string>
+
+#define BENCH_DEFAULT_COLUMNS 160
+#define BENCH_DEFAULT_ROWS 48
+#define BENCH_DEFAULT_SINK "/dev/null"
+
+// Run the video of -m through decode -> scale -> ASCII -> output as fast as possible,
+// without a terminal, audio or pacing, and print the throughput of every stage.
+// Options: --size COLSxROWS (virtual terminal), --sink PATH (e.g. a pty), --frames N,
+// -color 256|truecolor, -glyphs half|braille|shape, --static-threshold N|off
+void bench_media(const std::map<std::string, std::string> &params);
+
+#endif /* player_bench_hpp */
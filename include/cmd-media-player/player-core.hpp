@@ -9,10 +9,12 @@
 #define video_player_hpp
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <iostream>
 
 #include <SDL2/SDL.h>
@@ -43,49 +45,161 @@ extern "C" {
 #include <unistd.h>
 #endif
 
+#include "audio-queue.hpp"
+#include "av-clock.hpp"
+#include "block-glyphs.hpp"
+#include "input-events.hpp"
+#include "media-queue.hpp"
 #include "player-basic.hpp"
+#include "trace.hpp"
+
+#define VIDEO_PACKET_QUEUE_SIZE 64
+#define AUDIO_PACKET_QUEUE_SIZE 128
+#define VIDEO_FRAME_QUEUE_SIZE 4
+
+#define DECODE_SKIP_MAX_LEVEL 3      // Skip the loop filter, then non-reference frames, then all but keyframes
+#define DECODE_SKIP_LATE_LIMIT 3     // Late frames within a second that raise the skip level
+#define DECODE_SKIP_RECOVER_TIME 3.0 // Seconds without late frames before the level goes back down
+#define LOWRES_OVERSAMPLE 2          // Source pixels per glyph sample to keep when decoding at low resolution
+#define LOWRES_RESERVE_COLUMNS 320   // Grid lowres leaves room for, the terminal may grow to it while playing
+#define LOWRES_RESERVE_ROWS 96
 
 extern SDL_AudioDeviceID audio_device_id;
 
-struct AudioQueue {
-    uint8_t *data;
-    int size;
-    SDL_mutex *mutex;
-    int64_t current_pts; // Add PTS tracking
-    double time_base;    // Add time base for accurate timing
+// A packet (or decoded frame) tagged with the seek serial it was read under.
+// A null pointer marks the end of the stream for that serial.
+struct PacketEntry {
+    AVPacket *packet;
+    int serial;
+};
+
+struct FrameEntry {
+    AVFrame *frame;
+    int serial;
+};
+
+using PacketQueue = BoundedQueue<PacketEntry>;
+using FrameQueue = BoundedQueue<FrameEntry>;
+
+// State shared between the demux, decode and render threads
+struct PlaybackState {
+    std::atomic<int> serial{0};           // Bumped on every seek, older packets and frames get dropped
+    std::atomic<int64_t> seek_target{-1}; // Pending seek target in seconds, -1 if none
+    std::atomic<int64_t> current_time{0}; // Latest decoded position in seconds
+    std::atomic<bool> stop{false};        // Set once playback has completed
 };
 
+// Per-stage state of the video decode thread
 struct VideoContext {
-    AVCodecContext *codec_ctx;
-    AVStream *stream;
-    int stream_index;
-    double fps;
+    AVCodecContext *codec_ctx = nullptr;
+    AVStream *stream = nullptr;
+    int stream_index = -1;
+    double fps = 0.0; // Nominal rate, the schedule itself follows the frame timestamps
+    std::atomic<int> skip_level{0}; // Set by the render thread, applied by the decode thread
+    PacketQueue packets{VIDEO_PACKET_QUEUE_SIZE};
+    FrameQueue frames{VIDEO_FRAME_QUEUE_SIZE};
+    std::thread decoder;
 };
 
+// Per-stage state of the audio decode thread
 struct AudioContext {
-    AVCodecContext *codec_ctx;
-    AVStream *stream;
-    int stream_index;
-    SwrContext *swr_ctx;
+    AVCodecContext *codec_ctx = nullptr;
+    AVStream *stream = nullptr;
+    int stream_index = -1;
+    SwrContext *swr_ctx = nullptr;
     AudioQueue queue;
-    SDL_AudioSpec spec;
+    AudioClock clock; // Master clock, driven by the audio callback
+    SDL_AudioSpec spec = {};
+    PacketQueue packets{AUDIO_PACKET_QUEUE_SIZE};
+    std::atomic<int> eof_serial{-1}; // Serial whose stream has been fully decoded
+    std::atomic<int> clock_serial{0}; // Serial the clock has been reset for
+    std::thread decoder;
 };
-enum class UserAction {
-    None,
-    Quit,
-    KeyLeft,
-    KeyRight,
-    KeyUp,
-    KeyDown,
-    KeyEqual,
-    KeyMinus,
-    KeySpace
+// Decides the decoder skip level from how many frames miss their deadline.
+// Raising is quick and lowering slow, so the level does not oscillate.
+struct DecodeThrottle {
+    int late_frames = 0;
+    double window_start = 0.0;
+    double last_late = 0.0;
+
+    // Report whether the frame at time `now` (seconds) was late, returns the new level
+    int update(bool late, double now, int level) {
+        if (now - window_start > 1.0) {
+            window_start = now;
+            late_frames = 0;
+        }
+        if (late) {
+            last_late = now;
+            if (++late_frames >= DECODE_SKIP_LATE_LIMIT && level < DECODE_SKIP_MAX_LEVEL) {
+                late_frames = 0;
+                return level + 1;
+            }
+        } else if (level > 0 && now - last_late > DECODE_SKIP_RECOVER_TIME) {
+            last_late = now; // Give the lower level a full period before stepping down again
+            return level - 1;
+        }
+        return level;
+    }
 };
 
+// Live numbers for the --stats overlay line, kept by the render thread
+struct PlaybackStats {
+    bool enabled = false;
+    double fps = 0.0;
+    int64_t dropped_frames = 0;
+    int64_t static_frames = 0; // Presented without redrawing, nothing visible changed
+    int quality_level = 0;     // Steps the quality governor has gone down, 0 is as chosen
+    double av_offset = NAN;  // Video ahead of audio (s) at the last frame, NAN while not synced
+    double audio_fill = NAN; // Fraction of the audio queue in use, NAN without audio
+    int window_frames = 0;
+    double window_start = 0.0;
+
+    // A frame was presented at `now` (seconds), fps is averaged over about a second
+    void on_frame(double now) {
+        window_frames++;
+        if (now - window_start >= 1.0) {
+            fps = window_start > 0.0 ? window_frames / (now - window_start) : 0.0;
+            window_start = now;
+            window_frames = 0;
+        }
+    }
+};
+
+extern PlaybackStats playback_stats;
+
 class NCursesHandler {
   private:
     bool has_quitted = false;
     int termWidth, termHeight;
+    InputEventThread events;
+
+    // Let ncurses catch up with a size the input thread has picked up
+    void apply_resize() {
+        get_terminal_size(termWidth, termHeight);
+        resizeterm(termHeight, termWidth);
+    }
+
+    // Block on the action queue until playback resumes (Space) or the player quits
+    UserAction pause() {
+        get_terminal_size(termWidth, termHeight);
+        mvprintw(termHeight - 1, termWidth - 2, "||");
+        refresh();
+        is_paused = true;
+        SDL_PauseAudioDevice(audio_device_id, 1); // Pause audio playback
+
+        UserAction action = UserAction::None;
+        while (action != UserAction::Quit && action != UserAction::KeySpace) {
+            action = events.wait_pop();
+            if (action == UserAction::Resize) {
+                apply_resize();
+                mvprintw(termHeight - 1, termWidth - 2, "||");
+                refresh();
+            }
+        }
+        is_paused = false;
+        SDL_PauseAudioDevice(audio_device_id, 0); // Resume audio playback, also before quitting
+        return action;
+    }
 
   public:
     bool is_paused = false;
@@ -97,71 +211,62 @@ class NCursesHandler {
         noecho();
         keypad(stdscr, TRUE);
         nodelay(stdscr, TRUE);
+        events.start();
     }
 
     ~NCursesHandler() {
         cleanup();
     }
 
+    // Stop the input thread, needed before reading keys with getch()
+    void stop_events() {
+        events.stop();
+    }
+
     void cleanup() {
         if (!has_quitted) {
             has_quitted = true;
+            events.stop();
             endwin();
         }
     }
 
-    UserAction handle_space() {
-        get_terminal_size(termWidth, termHeight);
-        if (!is_paused) {
-            mvprintw(termHeight - 1, termWidth - 2, "||");
-            refresh();
-            is_paused = true;
-            nodelay(stdscr, FALSE);
-            SDL_PauseAudioDevice(audio_device_id, 1); // Pause audio playback
+    // Next pending action, None if there is none; does not block unless it pauses
+    UserAction handleInput() {
+        UserAction action = UserAction::None;
+        if (!events.try_pop(action)) {
+            return UserAction::None;
         }
-        UserAction res = handleInput(true);
-        switch (res) {
-            case UserAction::Quit:
-                is_paused = false;
-                nodelay(stdscr, TRUE);
-                SDL_PauseAudioDevice(audio_device_id, 0); // Resume audio before quitting
-                return UserAction::Quit;
+        switch (action) {
             case UserAction::KeySpace:
-                is_paused = false;
-                nodelay(stdscr, TRUE);
-                SDL_PauseAudioDevice(audio_device_id, 0); // Resume audio playback
-                return UserAction::KeySpace;
+                return pause();
+            case UserAction::Resize:
+                apply_resize();
+                return UserAction::Resize;
             default:
-                return handle_space();
-        }
-    }
-
-    UserAction handleInput(bool last_space = false) {
-        switch (getch()) {
-            case ERR:
-                return UserAction::None;
-            case 27: // ESC key
-            case 3:  // Ctrl+C
-                return UserAction::Quit;
-            case ' ':
-                return last_space ? UserAction::KeySpace : handle_space();
-            case KEY_LEFT:
-                return UserAction::KeyLeft;
-            case KEY_RIGHT:
-                return UserAction::KeyRight;
-            case KEY_UP:
-                return UserAction::KeyUp;
-            case KEY_DOWN:
-                return UserAction::KeyDown;
-            case '=':
-                return UserAction::KeyEqual;
-            case '-':
-                return UserAction::KeyMinus;
-            default:
-                return UserAction::None;
+                return action;
         }
     }
 };
+// The converters append the frame to a caller-owned buffer so it can be reused across frames
+using AsciiConverter = std::function<void(const cv::Mat &, int, const char *, std::string &)>;
+
+extern std::atomic<bool> quit;
+void handle_sigint(int sig);
+
+extern std::vector<std::string> ascii_char_sets;
+extern int current_char_set_index;
+
+// Rendering options shared by playback and the benchmark
+AsciiConverter select_ascii_converter(const std::map<std::string, std::string> &params);
+void select_char_set(const std::map<std::string, std::string> &params);
+
+int parse_thread_count(const std::string &value);
+std::string describe_decoder_threads(const AVCodecContext *codec_ctx);
+// `glyph_mode` sets how many pixels each cell samples, the decoder keeps enough of them
+bool initialize_video(AVFormatContext *format_ctx, VideoContext &video_ctx, int thread_count,
+                      int termWidth, int termHeight, GlyphMode glyph_mode, bool debug_mode);
+
 void play_media(const std::map<std::string, std::string> &params);
 
 #endif /* video_player_hpp */
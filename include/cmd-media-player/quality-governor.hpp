@@ -0,0 +1,82 @@
+//
+//  quality-governor.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef quality_governor_hpp
+#define quality_governor_hpp
+
+#include <array>
+#include <climits>
+#include <vector>
+
+#include "ansi-color.hpp"
+#include "block-glyphs.hpp"
+
+#define GOVERNOR_BUDGET_SHARE 0.75  // Share of the frame interval the render stages may take
+#define GOVERNOR_RAISE_SHARE 0.7    // A higher level must be predicted to fit in this share of the budget
+#define GOVERNOR_SMOOTHING 0.1      // Weight of a new frame in the stage costs
+#define GOVERNOR_SETTLE_FRAMES 10   // Frames on a level before its costs are trusted
+#define GOVERNOR_HOLD_TIME 2.0      // Seconds on a level before stepping back up
+#define GOVERNOR_MAX_HOLD_TIME 32.0 // The hold doubles whenever a step up has to be undone, up to this
+
+enum RenderStage {
+    STAGE_SCALE,
+    STAGE_CONVERT, // Glyphs and colours into the grid
+    STAGE_OUTPUT,  // Terminal write and overlay
+    RENDER_STAGE_COUNT
+};
+
+// Seconds per frame spent in each stage
+using StageCosts = std::array<double, RENDER_STAGE_COUNT>;
+
+// Everything the governor trades for speed
+struct QualityLevel {
+    GlyphMode glyph_mode = GlyphMode::Ascii;
+    ColorMode color_mode = ColorMode::None;
+    int char_set_cap = INT_MAX; // Highest charset index, the keys still pick below it
+    int resolution = 100;       // Percent of the terminal the frame may cover
+
+    bool operator==(const QualityLevel &) const = default;
+};
+
+// `top` followed by ever cheaper levels, each giving up one thing: truecolor,
+// the heavier glyph modes, resolution, colour, then charset length
+std::vector<QualityLevel> build_quality_ladder(const QualityLevel &top);
+
+// Picks the quality level from the smoothed cost of every stage against the frame
+// interval. It steps down as soon as the costs settle over the budget, and back up
+// only after a hold time and when the predicted cost of the level above leaves
+// headroom. The prediction scales each stage by the cost ratio between the two
+// levels, guessed from their settings at first and measured on every move.
+class QualityGovernor {
+  private:
+    std::vector<QualityLevel> ladder;
+    std::vector<StageCosts> raise_ratios; // Cost of level i over level i + 1, per stage
+    StageCosts costs = {};                // Smoothed, on the current level
+    StageCosts left_costs = {};           // Of the level moved away from
+    int level = 0;
+    int left_level = -1;
+    int frames = 0;                       // Measured on the current level
+    double changed_at = 0.0;
+    double hold_time = GOVERNOR_HOLD_TIME;
+    int change_count = 0;
+
+    void move_to(int next, double now);
+
+  public:
+    // A single level keeps the quality fixed
+    void init(const std::vector<QualityLevel> &levels);
+
+    const QualityLevel &current() const { return ladder[level]; }
+    int current_level() const { return level; }
+    int level_count() const { return static_cast<int>(ladder.size()); }
+    int changes() const { return change_count; }
+
+    // Report the stage costs of a drawn frame with `interval` seconds per frame, true if the level changed
+    bool update(const StageCosts &frame, double interval, double now);
+};
+
+#endif /* quality_governor_hpp */
@@ -0,0 +1,43 @@
+//
+//  static-frame.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef static_frame_hpp
+#define static_frame_hpp
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#define STATIC_FRAME_DEFAULT_THRESHOLD 1.0 // Mean difference per sample that still counts as the same frame
+
+// "off", or the mean absolute difference per sample below which a row counts as unchanged
+double parse_static_threshold(const std::string &value);
+
+// Tells whether a scaled frame would draw the same as the one on screen, so the
+// glyph conversion and the output can be skipped. Frames are compared with the
+// last one drawn, not the previous one, so slow drift still adds up to a redraw.
+class StaticFrameDetector {
+  private:
+    cv::Mat reference;                // Scaled image of the frame on screen
+    const char *reference_chars = nullptr;
+    double threshold = STATIC_FRAME_DEFAULT_THRESHOLD;
+    bool valid = false;
+
+  public:
+    // Negative turns the detection off
+    void set_threshold(double value) { threshold = value; }
+    bool enabled() const { return threshold >= 0.0; }
+
+    // The screen no longer shows the reference, e.g. after a resize
+    void invalidate() { valid = false; }
+
+    // True if no row of `image` differs from the reference by more than the threshold.
+    // Otherwise `image` is about to be drawn and becomes the reference.
+    bool unchanged(const cv::Mat &image, const char *frame_chars);
+};
+
+#endif /* static_frame_hpp */
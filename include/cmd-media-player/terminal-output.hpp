@@ -0,0 +1,39 @@
+//
+//  terminal-output.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef terminal_output_hpp
+#define terminal_output_hpp
+
+#include <string>
+
+#include "frame-diff.hpp"
+
+// Writes frames straight to the terminal with ANSI escapes, bypassing ncurses.
+// Each frame goes out with a single write(2) wrapped in a synchronized update
+// (DEC mode 2026), so terminals that support it never show half-drawn frames.
+// ncurses stays in charge of input and the overlay rows.
+class AnsiFrameWriter {
+  private:
+    int fd;
+    std::string buffer; // Reused across frames
+    size_t last_size = 0;
+
+  public:
+    explicit AnsiFrameWriter(int fd);
+
+    // Write the cells of `diff` that changed since the last frame.
+    // The cursor is saved and restored around the frame so ncurses' idea of it stays valid.
+    bool write_frame(FrameDiff &diff);
+
+    // Bytes the last write_frame() emitted, 0 if nothing had changed
+    size_t last_frame_size() const { return last_size; }
+};
+
+// Write all of `data` to `fd`, retrying on short writes and EINTR
+bool write_all(int fd, const char *data, size_t size);
+
+#endif /* terminal_output_hpp */
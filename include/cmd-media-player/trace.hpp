@@ -0,0 +1,62 @@
+//
+//  trace.hpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#ifndef trace_hpp
+#define trace_hpp
+
+#include <atomic>
+#include <string>
+
+#include "av-clock.hpp"
+
+#define TRACE_RESERVE_EVENTS (1 << 16) // Per thread, so recording rarely allocates
+
+// Timeline of the pipeline stages for --trace, written in the Chrome trace event
+// format (chrome://tracing, ui.perfetto.dev). Every thread records into a buffer
+// of its own without locking; the buffers are only merged when the file is written.
+
+extern std::atomic<bool> trace_active;
+
+// Start a new recording that trace_stop() writes to `path`
+void trace_start(const std::string &path);
+
+// Write the recording out, once every thread that records has finished
+bool trace_stop();
+
+// Name the calling thread in the trace
+void trace_thread_name(const char *name);
+
+inline bool trace_enabled() {
+    return trace_active.load(std::memory_order_relaxed);
+}
+
+// Start time for trace_span(), 0 while not recording so the clock is not even read
+inline double trace_now() {
+    return trace_enabled() ? clock_seconds() : 0.0;
+}
+
+// Record a span from `start` until now. Names are kept by pointer, so they must be literals
+void trace_span(const char *name, double start);
+
+// Record the current value of a counter
+void trace_counter(const char *name, double value);
+
+// Span covering the rest of the enclosing block
+class TraceScope {
+  private:
+    const char *name;
+    double start;
+
+  public:
+    explicit TraceScope(const char *name) : name(name), start(trace_now()) {}
+    ~TraceScope() { trace_span(name, start); }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+};
+
+#endif /* trace_hpp */
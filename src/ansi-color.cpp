@@ -0,0 +1,125 @@
+//
+//  ansi-color.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/ansi-color.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <vector>
+
+ColorMode parse_color_mode(const std::string &value) {
+    if (value == "256") {
+        return ColorMode::Palette256;
+    }
+    if (value == "truecolor" || value == "24bit") {
+        return ColorMode::TrueColor;
+    }
+    return ColorMode::None;
+}
+
+// RGB of an xterm palette entry. 0-15 are left out, terminal themes redefine them
+static std::array<int, 3> xterm256_rgb(int index) {
+    static const int cube_levels[6] = {0, 95, 135, 175, 215, 255};
+    if (index >= 232) {
+        int level = 8 + (index - 232) * 10;
+        return {level, level, level};
+    }
+    index -= 16;
+    return {cube_levels[index / 36], cube_levels[index / 6 % 6], cube_levels[index % 6]};
+}
+
+static std::vector<uint8_t> build_xterm256_lut() {
+    std::vector<uint8_t> lut(32 * 32 * 32);
+    std::array<int, 3> palette[256];
+    for (int index = 16; index < 256; ++index) {
+        palette[index] = xterm256_rgb(index);
+    }
+    for (int cell = 0; cell < 32 * 32 * 32; ++cell) {
+        // Centre of the 8x8x8 block of colours this entry stands for
+        int r = (cell >> 10) * 8 + 4, g = (cell >> 5 & 31) * 8 + 4, b = (cell & 31) * 8 + 4;
+        int best = 16, best_distance = 1 << 30;
+        for (int index = 16; index < 256; ++index) {
+            int dr = r - palette[index][0], dg = g - palette[index][1], db = b - palette[index][2];
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = index;
+            }
+        }
+        lut[cell] = static_cast<uint8_t>(best);
+    }
+    return lut;
+}
+
+const uint8_t *xterm256_lut() {
+    static const std::vector<uint8_t> lut = build_xterm256_lut();
+    return lut.data();
+}
+
+struct EscapeText {
+    char text[20];
+    uint8_t length;
+};
+
+// SGR 38;5;N (foreground) or 48;5;N (background) for every palette entry
+static const std::array<EscapeText, 256> &palette_escapes(bool background) {
+    static const auto build = [](const char *prefix) {
+        std::array<EscapeText, 256> table;
+        for (int index = 0; index < 256; ++index) {
+            EscapeText &escape = table[index];
+            char *end = std::copy_n(prefix, 7, escape.text);
+            end = std::to_chars(end, escape.text + sizeof(escape.text), index).ptr;
+            *end++ = 'm';
+            escape.length = static_cast<uint8_t>(end - escape.text);
+        }
+        return table;
+    };
+    static const std::array<EscapeText, 256> foreground = build("\033[38;5;");
+    static const std::array<EscapeText, 256> backgrounds = build("\033[48;5;");
+    return background ? backgrounds : foreground;
+}
+
+// Decimal text of 0-255, with its length in the last byte
+static const std::array<std::array<char, 4>, 256> &decimal_bytes() {
+    static const std::array<std::array<char, 4>, 256> table = [] {
+        std::array<std::array<char, 4>, 256> digits;
+        for (int value = 0; value < 256; ++value) {
+            char *end = std::to_chars(digits[value].data(), digits[value].data() + 3, value).ptr;
+            digits[value][3] = static_cast<char>(end - digits[value].data());
+        }
+        return digits;
+    }();
+    return table;
+}
+
+// Escape for one half of a key
+static void append_color_escape(std::string &out, uint32_t key, bool background) {
+    if (key & COLOR_KEY_PALETTE) {
+        const EscapeText &escape = palette_escapes(background)[key & 0xFF];
+        out.append(escape.text, escape.length);
+    } else if (key & COLOR_KEY_RGB) {
+        const auto &digits = decimal_bytes();
+        out.append(background ? "\033[48;2;" : "\033[38;2;", 7);
+        for (int shift = 16; shift >= 0; shift -= 8) {
+            const std::array<char, 4> &channel = digits[key >> shift & 0xFF];
+            out.append(channel.data(), channel[3]);
+            out += shift ? ';' : 'm';
+        }
+    } else {
+        out.append(background ? "\033[49m" : "\033[39m", 5); // Default colour
+    }
+}
+
+void append_color_change(std::string &out, ColorKey from, ColorKey to) {
+    if (static_cast<uint32_t>(from) != static_cast<uint32_t>(to)) {
+        append_color_escape(out, static_cast<uint32_t>(to), false);
+    }
+    if (from >> COLOR_KEY_BG_SHIFT != to >> COLOR_KEY_BG_SHIFT) {
+        append_color_escape(out, static_cast<uint32_t>(to >> COLOR_KEY_BG_SHIFT), true);
+    }
+}
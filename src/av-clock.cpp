@@ -0,0 +1,147 @@
+//
+//  av-clock.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/av-clock.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <time.h>
+
+// Decoded timestamps further off than this from the running byte count re-anchor the clock
+#define AUDIO_CLOCK_RESYNC_THRESHOLD 0.1
+
+#ifdef __linux__
+
+double clock_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void sleep_until_seconds(double deadline) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadline);
+    ts.tv_nsec = static_cast<long>((deadline - ts.tv_sec) * 1e9);
+    // Absolute deadline: being woken up by a signal and sleeping again does not add up drift
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+#else
+
+double clock_seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void sleep_until_seconds(double deadline) {
+    auto target = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(deadline));
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(target));
+}
+
+#endif
+
+void JitterStats::add(double error) {
+    int bucket = static_cast<int>(std::fabs(error) / JITTER_BUCKET_SECONDS);
+    buckets[std::min(bucket, JITTER_BUCKETS - 1)]++;
+    samples++;
+    sum += error;
+    worst = std::max(worst, std::fabs(error));
+}
+
+double JitterStats::percentile(double fraction) const {
+    uint64_t target = static_cast<uint64_t>(std::ceil(samples * fraction));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < JITTER_BUCKETS; ++bucket) {
+        seen += buckets[bucket];
+        if (seen >= target && seen > 0) {
+            return (bucket + 1) * JITTER_BUCKET_SECONDS;
+        }
+    }
+    return 0.0;
+}
+
+void FrameScheduler::anchor(double pts, double now) {
+    anchored = true;
+    anchor_time = now;
+    anchor_pts = pts;
+    last_deadline = now - duration;
+}
+
+double FrameScheduler::deadline(double pts, double now) {
+    if (!anchored || (std::isnan(anchor_pts) && !std::isnan(pts))) {
+        anchor(pts, now);
+    }
+    if (std::isnan(pts)) {
+        return last_deadline + duration;
+    }
+    double deadline = anchor_time + (pts - anchor_pts);
+    if (deadline < last_deadline || deadline - last_deadline > FRAME_SCHEDULER_MAX_DRIFT ||
+        now - deadline > FRAME_SCHEDULER_MAX_DRIFT) {
+        // Timestamp jump or a long stall, start over from this frame instead of racing or waiting
+        anchor(pts, now);
+        deadline = now;
+    }
+    return deadline;
+}
+
+void FrameScheduler::presented(double pts, double deadline, double now) {
+    stats.add(now - deadline);
+    double delta = pts - last_pts;
+    if (delta > 0.0 && delta < FRAME_SCHEDULER_MAX_DRIFT) {
+        duration = delta;
+    }
+    last_pts = pts;
+    last_deadline = deadline;
+}
+
+void AudioClock::init(double bytes_per_second) {
+    this->bytes_per_second = bytes_per_second;
+    reset();
+}
+
+void AudioClock::on_push(uint64_t pos, uint64_t len, double pts) {
+    if (bytes_per_second <= 0) {
+        return;
+    }
+    if (!std::isnan(pts) && (!anchored || std::fabs(pts - expected_pts) > AUDIO_CLOCK_RESYNC_THRESHOLD)) {
+        anchor.store({static_cast<double>(generation.load()), static_cast<double>(pos), pts});
+        anchored = true;
+        expected_pts = pts;
+    }
+    expected_pts += len / bytes_per_second;
+}
+
+void AudioClock::reset() {
+    generation++;
+    anchored = false;
+}
+
+void AudioClock::on_consume(uint64_t pos, uint64_t count, uint64_t device_len) {
+    double mark[3];
+    if (bytes_per_second <= 0 || !anchor.try_load(mark, 1) || mark[0] != generation.load()) {
+        return;
+    }
+    double start_pts = mark[2] + (static_cast<double>(pos) - mark[1]) / bytes_per_second;
+    double end_pts = start_pts + count / bytes_per_second;
+
+    // What was just handed over starts playing once the device buffer ahead of it drained
+    double heard_pts = start_pts - device_len / bytes_per_second;
+    heard.store({mark[0], heard_pts, clock_seconds(), end_pts});
+}
+
+bool AudioClock::now(double &pts) const {
+    double sample[4];
+    if (!heard.try_load(sample) || sample[0] != generation.load()) {
+        return false;
+    }
+    // Playback moves on in real time, but never past the audio the device has been given
+    pts = std::min(sample[1] + (clock_seconds() - sample[2]), sample[3]);
+    return true;
+}
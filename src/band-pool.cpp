@@ -0,0 +1,92 @@
+//
+//  band-pool.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/band-pool.hpp"
+
+#include <algorithm>
+
+BandPool::BandPool(int worker_count) : participants(worker_count + 1) {
+    workers.reserve(worker_count);
+    for (int i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&BandPool::worker_loop, this, i + 1);
+    }
+}
+
+BandPool::~BandPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void BandPool::worker_loop(int index) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+        const std::function<void(int)> *fn = task;
+        int count = total;
+        lock.unlock();
+        for (int band = index; band < count; band += participants) {
+            (*fn)(band);
+        }
+        lock.lock();
+        if (++finished == size()) {
+            done.notify_one();
+        }
+    }
+}
+
+void BandPool::run(int count, const std::function<void(int)> &fn) {
+    if (participants == 1 || count <= 1) {
+        for (int band = 0; band < count; ++band) {
+            fn(band);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        total = count;
+        finished = 0;
+        generation++;
+    }
+    wake.notify_all();
+    for (int band = 0; band < count; band += participants) {
+        fn(band);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return finished == size(); });
+}
+
+BandPool &render_band_pool() {
+    static BandPool pool(std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0,
+                                    BAND_POOL_MAX_WORKERS));
+    return pool;
+}
+
+int row_band_count(int rows, int64_t cells) {
+    if (cells < ROW_BANDS_MIN_CELLS) {
+        return 1;
+    }
+    return std::max(1, std::min(render_band_pool().size() + 1, rows / ROW_BANDS_MIN_ROWS));
+}
+
+void for_each_row_band(int rows, int bands, const std::function<void(int, int, int)> &fn) {
+    render_band_pool().run(bands, [&](int band) {
+        fn(band, rows * band / bands, rows * (band + 1) / bands);
+    });
+}
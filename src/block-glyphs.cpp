@@ -0,0 +1,158 @@
+//
+//  block-glyphs.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/block-glyphs.hpp"
+
+#include "cmd-media-player/glyph-atlas.hpp"
+
+GlyphMode parse_glyph_mode(const std::string &value) {
+    if (value == "half") {
+        return GlyphMode::HalfBlock;
+    }
+    if (value == "braille") {
+        return GlyphMode::Braille;
+    }
+    if (value == "shape") {
+        return GlyphMode::Shape;
+    }
+    return GlyphMode::Ascii;
+}
+
+int glyph_mode_columns(GlyphMode mode) {
+    switch (mode) {
+    case GlyphMode::Braille:
+        return 2;
+    case GlyphMode::Shape:
+        return GLYPH_CELL_COLUMNS;
+    default:
+        return 1;
+    }
+}
+
+int glyph_mode_rows(GlyphMode mode) {
+    switch (mode) {
+    case GlyphMode::HalfBlock:
+        return 2;
+    case GlyphMode::Braille:
+        return 4;
+    case GlyphMode::Shape:
+        return GLYPH_CELL_ROWS;
+    default:
+        return 1;
+    }
+}
+
+bool glyph_mode_is_unicode(GlyphMode mode) {
+    return mode == GlyphMode::HalfBlock || mode == GlyphMode::Braille;
+}
+
+static GlyphBytes utf8_glyph(char32_t code_point) {
+    GlyphBytes glyph = {};
+    if (code_point < 0x80) {
+        glyph.bytes[0] = static_cast<char>(code_point);
+        glyph.length = 1;
+    } else {
+        // Every glyph used here is in U+0800-U+FFFF
+        glyph.bytes[0] = static_cast<char>(0xE0 | code_point >> 12);
+        glyph.bytes[1] = static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+        glyph.bytes[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+        glyph.length = 3;
+    }
+    return glyph;
+}
+
+const GlyphEncoding &half_block_encoding() {
+    static const GlyphEncoding encoding = [] {
+        GlyphEncoding table;
+        table.fill(utf8_glyph(' '));
+        table[HALF_BLOCK_UPPER] = utf8_glyph(U'\u2580');
+        table[HALF_BLOCK_LOWER] = utf8_glyph(U'\u2584');
+        table[HALF_BLOCK_FULL] = utf8_glyph(U'\u2588');
+        return table;
+    }();
+    return encoding;
+}
+
+const GlyphEncoding &braille_encoding() {
+    static const GlyphEncoding encoding = [] {
+        GlyphEncoding table;
+        for (int code = 0; code < 256; ++code) {
+            int pattern = code ^ 0x20;
+            // Plain space for the empty pattern, it is shorter and the same to look at
+            table[code] = utf8_glyph(pattern ? U'\u2800' + pattern : U' ');
+        }
+        return table;
+    }();
+    return encoding;
+}
+
+static inline int luma(const uint8_t *rgb) {
+    return (77 * rgb[0] + 150 * rgb[1] + 29 * rgb[2]) >> 8;
+}
+
+void map_half_blocks(const cv::Mat &image, ColorMode mode, char *cells, ColorKey *colors, size_t stride) {
+    const bool colored = mode != ColorMode::None;
+    for (int row = 0; row < image.rows / 2; ++row) {
+        const uint8_t *top = image.ptr<uint8_t>(2 * row);
+        const uint8_t *bottom = image.ptr<uint8_t>(2 * row + 1);
+        char *out = cells + stride * row;
+        if (colored) {
+            // Always the upper half, the two colours carry the picture
+            ColorKey *keys = colors + stride * row;
+            for (int col = 0; col < image.cols; ++col) {
+                const uint8_t *upper = top + 3 * col;
+                const uint8_t *lower = bottom + 3 * col;
+                out[col] = HALF_BLOCK_UPPER;
+                keys[col] = color_key_pair(color_key(upper[0], upper[1], upper[2], mode),
+                                           color_key(lower[0], lower[1], lower[2], mode));
+            }
+        } else {
+            static const char codes[4] = {' ', HALF_BLOCK_UPPER, HALF_BLOCK_LOWER, HALF_BLOCK_FULL};
+            for (int col = 0; col < image.cols; ++col) {
+                out[col] = codes[(top[col] >= BLOCK_THRESHOLD) | (bottom[col] >= BLOCK_THRESHOLD) << 1];
+            }
+        }
+    }
+}
+
+void map_braille(const cv::Mat &image, ColorMode mode, char *cells, ColorKey *colors, size_t stride) {
+    // Dot bit of each pixel of the 2x4 cell: dots 1-3 and 4-6 run down the two
+    // columns, dots 7 and 8 are the bottom row
+    static const uint8_t dot_bits[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+    const bool colored = mode != ColorMode::None;
+    const int channels = colored ? 3 : 1;
+    for (int row = 0; row < image.rows / 4; ++row) {
+        const uint8_t *lines[4];
+        for (int y = 0; y < 4; ++y) {
+            lines[y] = image.ptr<uint8_t>(4 * row + y);
+        }
+        char *out = cells + stride * row;
+        for (int col = 0; col < image.cols / 2; ++col) {
+            int pattern = 0;
+            int lit = 0, r = 0, g = 0, b = 0;
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 2; ++x) {
+                    const uint8_t *pixel = lines[y] + (2 * col + x) * channels;
+                    if ((colored ? luma(pixel) : pixel[0]) >= BLOCK_THRESHOLD) {
+                        pattern |= dot_bits[y][x];
+                        if (colored) {
+                            // The dots take the average colour of the pixels they stand for
+                            lit++;
+                            r += pixel[0];
+                            g += pixel[1];
+                            b += pixel[2];
+                        }
+                    }
+                }
+            }
+            out[col] = static_cast<char>(pattern ^ 0x20);
+            if (lit) {
+                colors[stride * row + col] = color_key(r / lit, g / lit, b / lit, mode);
+            }
+        }
+    }
+}
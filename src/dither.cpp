@@ -0,0 +1,174 @@
+//
+//  dither.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/dither.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "cmd-media-player/render-basic.hpp"
+
+static const int BAYER_4X4[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+void image_to_ascii_bayer(const cv::Mat &image, int pre_space, const char *asciiChars, std::string &asciiImage) {
+    const int levels = static_cast<int>(strlen(asciiChars));
+    if (levels < 2 || image.empty()) {
+        image_to_ascii(image, pre_space, asciiChars, asciiImage);
+        return;
+    }
+
+    // Offset of every matrix cell, as separate raise and lower patterns for the saturating kernel
+    uint8_t raise[4][DITHER_PATTERN_SIZE], lower[4][DITHER_PATTERN_SIZE];
+    const double level_size = 256.0 / levels;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < DITHER_PATTERN_SIZE; ++x) {
+            int offset = static_cast<int>(lround(((BAYER_4X4[y][x % 4] + 0.5) / 16.0 - 0.5) * level_size));
+            raise[y][x] = static_cast<uint8_t>(std::clamp(offset, 0, 255));
+            lower[y][x] = static_cast<uint8_t>(std::clamp(-offset, 0, 255));
+        }
+    }
+
+    // Bound by reference, the band workers would see their own thread_local otherwise
+    thread_local cv::Mat dithered_buffer;
+    cv::Mat &dithered = dithered_buffer;
+    dithered.create(image.rows, image.cols, CV_8UC1);
+    int bands = row_band_count(image.rows, static_cast<int64_t>(image.total()));
+    for_each_row_band(image.rows, bands, [&](int band, int first_row, int end_row) {
+        for (int y = first_row; y < end_row; ++y) {
+            dither_row(image.ptr<uchar>(y), image.cols, raise[y % 4], lower[y % 4], dithered.ptr<uchar>(y));
+        }
+    });
+    map_pixels_to_ascii(dithered, pre_space, glyph_table_for(asciiChars), asciiImage);
+}
+
+// Table from a level index to its glyph, rebuilt when the charset changes
+static const GlyphTable &level_table_for(const char *asciiChars) {
+    thread_local std::string cached_chars;
+    thread_local GlyphTable table = {};
+    thread_local bool built = false;
+    if (!built || cached_chars != asciiChars) {
+        std::array<char, 256> lut;
+        size_t levels = strlen(asciiChars);
+        for (size_t level = 0; level < lut.size(); ++level) {
+            lut[level] = asciiChars[std::min(level, levels - 1)];
+        }
+        cached_chars = asciiChars;
+        build_glyph_table(lut, table);
+        built = true;
+    }
+    return table;
+}
+
+enum class Diffusion {
+    FloydSteinberg, // 7/16 right, 3/16, 5/16 and 1/16 below
+    Atkinson        // 1/8 to the two right, the three below and the one two rows down, 2/8 dropped
+};
+
+// Diffuse the quantization error of `image` over its neighbours and write the level
+// of every pixel to `level_image`. Error rows are written by one row each, Floyd-Steinberg
+// only pushes to the row below and Atkinson has a second buffer for two rows down,
+// so a row only has to wait for the rows above to get far enough.
+static void diffuse_levels(const cv::Mat &image, int levels, Diffusion kernel, cv::Mat &level_image) {
+    const int rows = image.rows, cols = image.cols;
+    const size_t stride = cols + 2; // One padding column on either side
+    const int denominator = kernel == Diffusion::FloydSteinberg ? 16 : 8;
+
+    // Bound by reference, the band workers would see their own thread_local otherwise
+    thread_local std::vector<int> below_buffer, two_below_buffer;
+    thread_local std::unique_ptr<std::atomic<int>[]> progress_buffer;
+    thread_local int progress_size = 0;
+    std::vector<int> &below = below_buffer;
+    std::vector<int> &two_below = two_below_buffer;
+    below.assign(stride * (rows + 1), 0);
+    two_below.assign(kernel == Diffusion::Atkinson ? stride * (rows + 2) : 0, 0);
+    if (progress_size < rows) {
+        progress_buffer.reset(new std::atomic<int>[rows]);
+        progress_size = rows;
+    }
+    std::atomic<int> *progress = progress_buffer.get();
+    for (int row = 0; row < rows; ++row) {
+        progress[row].store(0, std::memory_order_relaxed);
+    }
+    level_image.create(rows, cols, CV_8UC1);
+
+    int bands = row_band_count(rows, static_cast<int64_t>(image.total()));
+    const bool pipelined = bands > 1;
+    auto diffuse_row = [&](int row) {
+        const uint8_t *pixels = image.ptr<uchar>(row);
+        uint8_t *out = level_image.ptr<uchar>(row);
+        const int *from_above = below.data() + stride * row + 1;
+        int *to_below = below.data() + stride * (row + 1) + 1;
+        const int *from_two_above = kernel == Diffusion::Atkinson ? two_below.data() + stride * row + 1 : nullptr;
+        int *to_two_below = kernel == Diffusion::Atkinson ? two_below.data() + stride * (row + 2) + 1 : nullptr;
+        int carry = 0, carry_next = 0; // Error numerators pushed to the next two pixels of the row
+
+        for (int x = 0; x < cols; ++x) {
+            if (pipelined && row > 0 && x % DITHER_PIPELINE_STEP == 0) {
+                int needed = std::min(cols, x + DITHER_PIPELINE_STEP - 1 + DITHER_PIPELINE_LAG);
+                while (progress[row - 1].load(std::memory_order_acquire) < needed) {
+                    std::this_thread::yield();
+                }
+            }
+            int error_in = carry + from_above[x] + (from_two_above ? from_two_above[x] : 0);
+            int value = std::clamp(pixels[x] + error_in / denominator, 0, 255);
+            int level = (value * (levels - 1) + 127) / 255;
+            int error = value - level * 255 / (levels - 1);
+            out[x] = static_cast<uint8_t>(level);
+
+            if (kernel == Diffusion::FloydSteinberg) {
+                carry = 7 * error;
+                to_below[x - 1] += 3 * error;
+                to_below[x] += 5 * error;
+                to_below[x + 1] += error;
+            } else {
+                carry = carry_next + error;
+                carry_next = error;
+                to_below[x - 1] += error;
+                to_below[x] += error;
+                to_below[x + 1] += error;
+                to_two_below[x] += error;
+            }
+            if (pipelined && (x + 1) % DITHER_PIPELINE_STEP == 0) {
+                progress[row].store(x + 1, std::memory_order_release);
+            }
+        }
+        if (pipelined) {
+            progress[row].store(cols, std::memory_order_release);
+        }
+    };
+
+    if (!pipelined) {
+        for (int row = 0; row < rows; ++row) {
+            diffuse_row(row);
+        }
+        return;
+    }
+    // One band per row, every participant takes its rows top to bottom
+    render_band_pool().run(rows, diffuse_row);
+}
+
+static void image_to_ascii_diffused(const cv::Mat &image, int pre_space, const char *asciiChars,
+                                    std::string &asciiImage, Diffusion kernel) {
+    const int levels = static_cast<int>(strlen(asciiChars));
+    if (levels < 2 || image.empty()) {
+        image_to_ascii(image, pre_space, asciiChars, asciiImage);
+        return;
+    }
+    thread_local cv::Mat level_image;
+    diffuse_levels(image, levels, kernel, level_image);
+    map_pixels_to_ascii(level_image, pre_space, level_table_for(asciiChars), asciiImage);
+}
+
+void image_to_ascii_floyd_steinberg(const cv::Mat &image, int pre_space, const char *asciiChars,
+                                    std::string &asciiImage) {
+    image_to_ascii_diffused(image, pre_space, asciiChars, asciiImage, Diffusion::FloydSteinberg);
+}
+
+void image_to_ascii_atkinson(const cv::Mat &image, int pre_space, const char *asciiChars, std::string &asciiImage) {
+    image_to_ascii_diffused(image, pre_space, asciiChars, asciiImage, Diffusion::Atkinson);
+}
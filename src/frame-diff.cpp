@@ -0,0 +1,149 @@
+//
+//  frame-diff.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/frame-diff.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+void FrameDiff::reset(int width, int height, const GlyphEncoding *encoding) {
+    width = std::max(width, 0);
+    height = std::max(height, 0);
+    size_t grid_size = static_cast<size_t>(width) * height;
+    if (width != this->width || height != this->height || previous.size() != grid_size) {
+        this->width = width;
+        this->height = height;
+        previous.assign(grid_size, ' ');
+        previous_colors.assign(colored ? grid_size : 0, 0);
+        repaint = true;
+    }
+    if (encoding != this->encoding) {
+        // The same codes stand for other glyphs now
+        this->encoding = encoding;
+        repaint = true;
+    }
+    cells.assign(grid_size, ' ');
+    if (colored) {
+        // Default colour unless the colours get loaded too, cells still in colour get redrawn
+        colors.assign(grid_size, 0);
+    }
+}
+
+void FrameDiff::load(const std::string &screen, int width, int height) {
+    reset(width, height, nullptr);
+    if (cells.empty()) {
+        return;
+    }
+
+    int row = 0, col = 0;
+    for (char c : screen) {
+        if (c == '\n') {
+            row++;
+            col = 0;
+        } else {
+            if (col == this->width) {
+                row++;
+                col = 0;
+            }
+            if (row < this->height) {
+                cells[static_cast<size_t>(row) * this->width + col] = c;
+            }
+            col++;
+        }
+        if (row >= this->height) {
+            break;
+        }
+    }
+}
+
+char *FrameDiff::load_codes(int width, int height, const GlyphEncoding *encoding) {
+    reset(width, height, encoding);
+    return cells.data();
+}
+
+ColorKey *FrameDiff::load_color_keys() {
+    if (!colored) {
+        // Everything on screen so far is in the default colour
+        size_t grid_size = static_cast<size_t>(width) * height;
+        colors.assign(grid_size, 0);
+        previous_colors.assign(grid_size, 0);
+        colored = true;
+    }
+    return colors.data();
+}
+
+void FrameDiff::load_colors(const uint8_t *rgb, size_t stride, int image_width, int image_height,
+                            int top, int left, ColorMode mode) {
+    ColorKey *keys = load_color_keys();
+    int rows = std::min(image_height, height - top);
+    int cols = std::min(image_width, width - left);
+    for (int y = std::max(0, -top); y < rows; ++y) {
+        const uint8_t *pixel = rgb + stride * y;
+        size_t index = static_cast<size_t>(top + y) * width + left;
+        for (int x = std::max(0, -left); x < cols; ++x) {
+            // Only the foreground is coloured, blanks look the same in any colour
+            if (cells[index + x] != ' ') {
+                const uint8_t *p = pixel + 3 * x;
+                keys[index + x] = color_key(p[0], p[1], p[2], mode);
+            }
+        }
+    }
+}
+
+// Append cells as their UTF-8 bytes, or as they are without an encoding
+static void append_cells(std::string &out, const char *text, int length, const GlyphEncoding *encoding) {
+    if (!encoding) {
+        out.append(text, length);
+        return;
+    }
+    // Copy 4 bytes per cell and advance by the real length, then trim the slack
+    size_t offset = out.size();
+    out.resize(offset + 4 * static_cast<size_t>(length));
+    char *end = out.data() + offset;
+    for (int i = 0; i < length; ++i) {
+        const GlyphBytes &glyph = (*encoding)[static_cast<uint8_t>(text[i])];
+        memcpy(end, glyph.bytes, 4);
+        end += glyph.length;
+    }
+    out.resize(end - out.data());
+}
+
+void FrameDiff::append_changes_as_ansi(std::string &out) {
+    // The writer saves and restores the cursor (DECSC/DECRC) around the frame, which brings
+    // back the colour it had before too, so every frame starts at the default colour
+    ColorKey current_color = 0;
+    const GlyphEncoding *encoding = this->encoding;
+    for_each_change([&](int row, int col, const char *text, const ColorKey *colors, int length) {
+        // CUP is 1-based: ESC [ row ; col H, each number in a buffer of its own
+        char row_text[12], col_text[12];
+        char *row_end = std::to_chars(row_text, row_text + sizeof(row_text), row + 1).ptr;
+        char *col_end = std::to_chars(col_text, col_text + sizeof(col_text), col + 1).ptr;
+        out.append("\033[", 2);
+        out.append(row_text, row_end);
+        out += ';';
+        out.append(col_text, col_end);
+        out += 'H';
+        if (!colors) {
+            append_cells(out, text, length, encoding);
+            return;
+        }
+        // Glyphs are copied in spans of one colour. Blanks join whatever span they are
+        // in, unless it has a background colour that would show through them.
+        int span_start = 0;
+        for (int i = 0; i < length; ++i) {
+            if (colors[i] != current_color &&
+                (text[i] != ' ' || current_color >> COLOR_KEY_BG_SHIFT)) {
+                append_cells(out, text + span_start, i - span_start, encoding);
+                append_color_change(out, current_color, colors[i]);
+                current_color = colors[i];
+                span_start = i;
+            }
+        }
+        append_cells(out, text + span_start, length - span_start, encoding);
+    });
+}
@@ -0,0 +1,55 @@
+//
+//  frame-scaler.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/frame-scaler.hpp"
+
+FrameScaler::~FrameScaler() {
+    sws_freeContext(gray.sws_ctx);
+    sws_freeContext(rgb.sws_ctx);
+}
+
+const cv::Mat &FrameScaler::convert(Conversion &conversion, const AVFrame *frame, int width, int height,
+                                    AVPixelFormat format, int type) {
+    cv::Mat &image = conversion.image;
+    if (width <= 0 || height <= 0 || frame->width <= 0 || frame->height <= 0) {
+        image = cv::Mat();
+        return image;
+    }
+
+    if (!conversion.sws_ctx || frame->width != conversion.src_width || frame->height != conversion.src_height ||
+        frame->format != conversion.src_format || width != conversion.dst_width || height != conversion.dst_height) {
+        // Area averaging keeps large reduction ratios from aliasing
+        conversion.sws_ctx = sws_getCachedContext(conversion.sws_ctx,
+                                                  frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                                  width, height, format,
+                                                  SWS_AREA, nullptr, nullptr, nullptr);
+        conversion.src_width = frame->width;
+        conversion.src_height = frame->height;
+        conversion.src_format = frame->format;
+        conversion.dst_width = width;
+        conversion.dst_height = height;
+    }
+
+    image.create(height, width, type);
+    if (!conversion.sws_ctx) {
+        image = cv::Mat();
+        return image;
+    }
+
+    uint8_t *dst_data[1] = {image.data};
+    int dst_linesize[1] = {static_cast<int>(image.step)};
+    sws_scale(conversion.sws_ctx, frame->data, frame->linesize, 0, frame->height, dst_data, dst_linesize);
+    return image;
+}
+
+const cv::Mat &FrameScaler::scale(const AVFrame *frame, int width, int height) {
+    return convert(gray, frame, width, height, AV_PIX_FMT_GRAY8, CV_8UC1);
+}
+
+const cv::Mat &FrameScaler::scale_rgb(const AVFrame *frame, int width, int height) {
+    return convert(rgb, frame, width, height, AV_PIX_FMT_RGB24, CV_8UC3);
+}
@@ -0,0 +1,181 @@
+//
+//  glyph-atlas.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/glyph-atlas.hpp"
+
+#include "cmd-media-player/band-pool.hpp"
+
+#include <climits>
+
+struct GlyphShape {
+    char glyph;
+    const char *rows[GLYPH_CELL_ROWS];
+};
+
+// Hand-drawn 4x8 shapes, '#' is ink. Symmetric glyphs are 3 wide around column 1,
+// the last column is the gap to the next cell.
+static const GlyphShape GLYPH_SHAPES[] = {
+    {'.', {"....", "....", "....", "....", "....", "....", ".#..", "...."}},
+    {',', {"....", "....", "....", "....", "....", "....", ".#..", "#..."}},
+    {'\'', {".#..", ".#..", "....", "....", "....", "....", "....", "...."}},
+    {'`', {"#...", ".#..", "....", "....", "....", "....", "....", "...."}},
+    {'"', {"#.#.", "#.#.", "....", "....", "....", "....", "....", "...."}},
+    {':', {"....", "....", ".#..", "....", "....", ".#..", "....", "...."}},
+    {'-', {"....", "....", "....", "....", "###.", "....", "....", "...."}},
+    {'_', {"....", "....", "....", "....", "....", "....", "....", "####"}},
+    {'=', {"....", "....", "....", "###.", "....", "###.", "....", "...."}},
+    {'~', {"....", "....", "....", ".#.#", "#.#.", "....", "....", "...."}},
+    {'^', {".#..", "#.#.", "....", "....", "....", "....", "....", "...."}},
+    {'+', {"....", "....", ".#..", ".#..", "###.", ".#..", ".#..", "...."}},
+    {'*', {"....", "....", "#.#.", ".#..", "###.", ".#..", "#.#.", "...."}},
+    {'|', {".#..", ".#..", ".#..", ".#..", ".#..", ".#..", ".#..", ".#.."}},
+    {'!', {".#..", ".#..", ".#..", ".#..", ".#..", "....", ".#..", "...."}},
+    {'/', {"...#", "...#", "..#.", "..#.", ".#..", ".#..", "#...", "#..."}},
+    {'\\', {"#...", "#...", ".#..", ".#..", "..#.", "..#.", "...#", "...#"}},
+    {'(', {"..#.", ".#..", "#...", "#...", "#...", "#...", ".#..", "..#."}},
+    {')', {".#..", "..#.", "...#", "...#", "...#", "...#", "..#.", ".#.."}},
+    {'[', {"###.", "#...", "#...", "#...", "#...", "#...", "#...", "###."}},
+    {']', {".###", "...#", "...#", "...#", "...#", "...#", "...#", ".###"}},
+    {'<', {"....", "...#", "..#.", ".#..", "#...", ".#..", "..#.", "...#"}},
+    {'>', {"....", "#...", ".#..", "..#.", "...#", "..#.", ".#..", "#..."}},
+    {'T', {"###.", ".#..", ".#..", ".#..", ".#..", ".#..", ".#..", "...."}},
+    {'L', {"#...", "#...", "#...", "#...", "#...", "#...", "####", "...."}},
+    {'J', {"...#", "...#", "...#", "...#", "...#", "#..#", ".##.", "...."}},
+    {'7', {"####", "...#", "..#.", "..#.", ".#..", ".#..", ".#..", "...."}},
+    {'Y', {"#.#.", "#.#.", ".#..", ".#..", ".#..", ".#..", ".#..", "...."}},
+    {'V', {"#.#.", "#.#.", "#.#.", "#.#.", "#.#.", ".#..", ".#..", "...."}},
+    {'A', {".#..", "#.#.", "#.#.", "###.", "#.#.", "#.#.", "#.#.", "...."}},
+    {'H', {"#.#.", "#.#.", "#.#.", "###.", "#.#.", "#.#.", "#.#.", "...."}},
+    {'U', {"#.#.", "#.#.", "#.#.", "#.#.", "#.#.", "#.#.", "###.", "...."}},
+    {'X', {"#.#.", "#.#.", ".#..", ".#..", ".#..", "#.#.", "#.#.", "...."}},
+    {'O', {"###.", "#.#.", "#.#.", "#.#.", "#.#.", "#.#.", "###.", "...."}},
+    {'E', {"###.", "#...", "#...", "###.", "#...", "#...", "###.", "...."}},
+    {'F', {"###.", "#...", "#...", "###.", "#...", "#...", "#...", "...."}},
+    {'P', {"##..", "#.#.", "#.#.", "##..", "#...", "#...", "#...", "...."}},
+    {'Z', {"####", "...#", "..#.", ".#..", "#...", "#...", "####", "...."}},
+    {'N', {"#..#", "##.#", "##.#", "#.##", "#.##", "#..#", "#..#", "...."}},
+    {'M', {"#..#", "####", "####", "#..#", "#..#", "#..#", "#..#", "...."}},
+    {'W', {"#..#", "#..#", "#..#", "#..#", "####", "####", "#..#", "...."}},
+    {'r', {"....", "....", "....", "#.#.", "##..", "#...", "#...", "...."}},
+    {'n', {"....", "....", "....", "##..", "#.#.", "#.#.", "#.#.", "...."}},
+    {'u', {"....", "....", "....", "#.#.", "#.#.", "#.#.", ".##.", "...."}},
+    {'o', {"....", "....", "....", ".#..", "#.#.", "#.#.", ".#..", "...."}},
+    {'c', {"....", "....", "....", ".##.", "#...", "#...", ".##.", "...."}},
+    {'v', {"....", "....", "....", "#.#.", "#.#.", "#.#.", ".#..", "...."}},
+    {'m', {"....", "....", "....", "####", "####", "#.##", "#.##", "...."}},
+    {'#', {"....", "#.#.", "###.", "#.#.", "###.", "#.#.", "....", "...."}},
+    {'%', {"#..#", "...#", "..#.", ".#..", ".#..", "#...", "#..#", "...."}},
+    {'@', {".##.", "#..#", "#.##", "#.##", "#.##", "#...", ".###", "...."}},
+};
+
+// Soften a block of ink with a 3x3 binomial filter and stretch it to 0-255, so a
+// stroke one sample off still scores closer than an unrelated shape. Templates
+// and frame blocks both go through it. False for a block without any contrast.
+static bool soften_block(const uint8_t *ink, uint8_t *out) {
+    int rows[GLYPH_BLOCK_SIZE], soft[GLYPH_BLOCK_SIZE];
+    for (int y = 0; y < GLYPH_CELL_ROWS; ++y) {
+        const uint8_t *line = ink + y * GLYPH_CELL_COLUMNS;
+        for (int x = 0; x < GLYPH_CELL_COLUMNS; ++x) {
+            int left = x > 0 ? line[x - 1] : 0, right = x + 1 < GLYPH_CELL_COLUMNS ? line[x + 1] : 0;
+            rows[y * GLYPH_CELL_COLUMNS + x] = left + 2 * line[x] + right;
+        }
+    }
+    int min_value = INT32_MAX, max_value = 0;
+    for (int y = 0; y < GLYPH_CELL_ROWS; ++y) {
+        for (int x = 0; x < GLYPH_CELL_COLUMNS; ++x) {
+            int index = y * GLYPH_CELL_COLUMNS + x;
+            int up = y > 0 ? rows[index - GLYPH_CELL_COLUMNS] : 0;
+            int down = y + 1 < GLYPH_CELL_ROWS ? rows[index + GLYPH_CELL_COLUMNS] : 0;
+            soft[index] = up + 2 * rows[index] + down;
+            min_value = std::min(min_value, soft[index]);
+            max_value = std::max(max_value, soft[index]);
+        }
+    }
+    int range = max_value - min_value;
+    if (range == 0) {
+        return false;
+    }
+    for (int i = 0; i < GLYPH_BLOCK_SIZE; ++i) {
+        out[i] = static_cast<uint8_t>((soft[i] - min_value) * 255 / range);
+    }
+    return true;
+}
+
+static GlyphAtlas build_glyph_atlas() {
+    GlyphAtlas atlas;
+    for (const GlyphShape &shape : GLYPH_SHAPES) {
+        uint8_t ink[GLYPH_BLOCK_SIZE];
+        for (int y = 0; y < GLYPH_CELL_ROWS; ++y) {
+            for (int x = 0; x < GLYPH_CELL_COLUMNS; ++x) {
+                ink[y * GLYPH_CELL_COLUMNS + x] = shape.rows[y][x] == '#' ? 255 : 0;
+            }
+        }
+        uint8_t soft[GLYPH_BLOCK_SIZE];
+        soften_block(ink, soft);
+        atlas.glyphs.push_back(shape.glyph);
+        atlas.templates.insert(atlas.templates.end(), soft, soft + GLYPH_BLOCK_SIZE);
+    }
+    return atlas;
+}
+
+const GlyphAtlas &glyph_atlas() {
+    static const GlyphAtlas atlas = build_glyph_atlas();
+    return atlas;
+}
+
+static inline int luma(const uint8_t *rgb) {
+    return (77 * rgb[0] + 150 * rgb[1] + 29 * rgb[2]) >> 8;
+}
+
+void map_shape_glyphs(const cv::Mat &image, ColorMode mode, const GlyphTable &density,
+                      char *cells, ColorKey *colors, size_t stride) {
+    const GlyphAtlas &atlas = glyph_atlas();
+    const int glyph_count = static_cast<int>(atlas.glyphs.size());
+    const bool colored = mode != ColorMode::None;
+    const int channels = colored ? 3 : 1;
+    const int rows = image.rows / GLYPH_CELL_ROWS, cols = image.cols / GLYPH_CELL_COLUMNS;
+
+    // Matching costs a few dozen SADs per cell, so even mid-sized grids go to the pool
+    int bands = row_band_count(rows, static_cast<int64_t>(rows) * cols * GLYPH_BLOCK_SIZE / 4);
+    for_each_row_band(rows, bands, [&](int band, int first_row, int end_row) {
+        uint8_t block[GLYPH_BLOCK_SIZE], soft[GLYPH_BLOCK_SIZE];
+        for (int row = first_row; row < end_row; ++row) {
+            char *out = cells + stride * row;
+            for (int col = 0; col < cols; ++col) {
+                // Gather the block as ink (dark is ink, like the charsets), with the colour sums on the side
+                int min_value = 255, max_value = 0, total = 0;
+                int r = 0, g = 0, b = 0;
+                for (int y = 0; y < GLYPH_CELL_ROWS; ++y) {
+                    const uint8_t *pixel = image.ptr<uchar>(row * GLYPH_CELL_ROWS + y) +
+                                           col * GLYPH_CELL_COLUMNS * channels;
+                    for (int x = 0; x < GLYPH_CELL_COLUMNS; ++x, pixel += channels) {
+                        int value = colored ? luma(pixel) : pixel[0];
+                        if (colored) {
+                            r += pixel[0];
+                            g += pixel[1];
+                            b += pixel[2];
+                        }
+                        block[y * GLYPH_CELL_COLUMNS + x] = static_cast<uint8_t>(255 - value);
+                        min_value = std::min(min_value, value);
+                        max_value = std::max(max_value, value);
+                        total += value;
+                    }
+                }
+
+                if (max_value - min_value < SHAPE_MIN_CONTRAST || !soften_block(block, soft)) {
+                    out[col] = density.lut[total / GLYPH_BLOCK_SIZE];
+                } else {
+                    out[col] = atlas.glyphs[match_glyph_block(soft, atlas.templates.data(), glyph_count)];
+                }
+                if (colored && out[col] != ' ') {
+                    colors[stride * row + col] = color_key(r / GLYPH_BLOCK_SIZE, g / GLYPH_BLOCK_SIZE,
+                                                           b / GLYPH_BLOCK_SIZE, mode);
+                }
+            }
+        }
+    });
+}
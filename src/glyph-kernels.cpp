@@ -0,0 +1,398 @@
+//
+//  glyph-kernels.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/glyph-kernels.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GLYPH_KERNELS_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define GLYPH_KERNELS_NEON
+#endif
+
+void build_glyph_table(const std::array<char, 256> &lut, GlyphTable &table) {
+    table.lut = lut;
+    table.runs = 0;
+    for (int pixel = 0; pixel < 256; ++pixel) {
+        if (pixel > 0 && lut[pixel] == lut[pixel - 1]) {
+            continue;
+        }
+        if (table.runs == GLYPH_TABLE_MAX_RUNS) {
+            // Too many runs for a 16-entry shuffle, only the scalar kernel can handle it
+            table.runs = GLYPH_TABLE_MAX_RUNS + 1;
+            return;
+        }
+        table.run_glyphs[table.runs] = static_cast<uint8_t>(lut[pixel]);
+        table.run_starts[table.runs] = static_cast<uint8_t>(pixel);
+        table.runs++;
+    }
+    std::fill(table.run_glyphs + table.runs, table.run_glyphs + GLYPH_TABLE_MAX_RUNS, table.run_glyphs[0]);
+    std::fill(table.run_starts + table.runs, table.run_starts + GLYPH_TABLE_MAX_RUNS, 0);
+}
+
+static void map_row_scalar(const uint8_t *pixels, int count, const GlyphTable &table, char *out) {
+    for (int i = 0; i < count; ++i) {
+        out[i] = table.lut[pixels[i]];
+    }
+}
+
+static void min_max_scalar(const uint8_t *pixels, int count, uint8_t &min_value, uint8_t &max_value) {
+    for (int i = 0; i < count; ++i) {
+        min_value = std::min(min_value, pixels[i]);
+        max_value = std::max(max_value, pixels[i]);
+    }
+}
+
+static void dither_row_scalar(const uint8_t *pixels, int count, const uint8_t *raise, const uint8_t *lower,
+                              uint8_t *out) {
+    for (int i = 0; i < count; ++i) {
+        int value = pixels[i] + raise[i % DITHER_PATTERN_SIZE] - lower[i % DITHER_PATTERN_SIZE];
+        out[i] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+}
+
+static int match_block_scalar(const uint8_t *block, const uint8_t *templates, int count) {
+    int best = 0, best_sad = INT32_MAX;
+    for (int glyph = 0; glyph < count; ++glyph) {
+        const uint8_t *shape = templates + glyph * GLYPH_BLOCK_SIZE;
+        int sad = 0;
+        for (int i = 0; i < GLYPH_BLOCK_SIZE; ++i) {
+            sad += std::abs(block[i] - shape[i]);
+        }
+        if (sad < best_sad) {
+            best_sad = sad;
+            best = glyph;
+        }
+    }
+    return best;
+}
+
+static uint64_t sum_abs_diff_scalar(const uint8_t *a, const uint8_t *b, int count) {
+    uint64_t sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += std::abs(a[i] - b[i]);
+    }
+    return sum;
+}
+
+// The vector kernels compute the run index of a pixel as the number of run starts
+// it is >= to, then shuffle the run glyphs with that index.
+
+#ifdef GLYPH_KERNELS_X86
+
+__attribute__((target("sse4.1"))) static void map_row_sse4(const uint8_t *pixels, int count,
+                                                          const GlyphTable &table, char *out) {
+    if (table.runs > GLYPH_TABLE_MAX_RUNS) {
+        map_row_scalar(pixels, count, table, out);
+        return;
+    }
+    const __m128i glyphs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(table.run_glyphs));
+    __m128i starts[GLYPH_TABLE_MAX_RUNS];
+    for (int run = 1; run < table.runs; ++run) {
+        starts[run] = _mm_set1_epi8(static_cast<char>(table.run_starts[run]));
+    }
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        __m128i index = _mm_setzero_si128();
+        for (int run = 1; run < table.runs; ++run) {
+            // pixel >= start <=> max(pixel, start) == pixel, the mask is -1 per matching byte
+            index = _mm_sub_epi8(index, _mm_cmpeq_epi8(_mm_max_epu8(pixel, starts[run]), pixel));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_shuffle_epi8(glyphs, index));
+    }
+    map_row_scalar(pixels + i, count - i, table, out + i);
+}
+
+__attribute__((target("sse4.1"))) static void min_max_sse4(const uint8_t *pixels, int count,
+                                                          uint8_t &min_value, uint8_t &max_value) {
+    __m128i min_acc = _mm_set1_epi8(static_cast<char>(min_value));
+    __m128i max_acc = _mm_set1_epi8(static_cast<char>(max_value));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        min_acc = _mm_min_epu8(min_acc, pixel);
+        max_acc = _mm_max_epu8(max_acc, pixel);
+    }
+    alignas(16) uint8_t mins[16], maxs[16];
+    _mm_store_si128(reinterpret_cast<__m128i *>(mins), min_acc);
+    _mm_store_si128(reinterpret_cast<__m128i *>(maxs), max_acc);
+    min_value = *std::min_element(mins, mins + 16);
+    max_value = *std::max_element(maxs, maxs + 16);
+    min_max_scalar(pixels + i, count - i, min_value, max_value);
+}
+
+// Vectors start at multiples of 16, so the pattern lines up with the pixels
+__attribute__((target("sse4.1"))) static void dither_row_sse4(const uint8_t *pixels, int count, const uint8_t *raise,
+                                                             const uint8_t *lower, uint8_t *out) {
+    const __m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i *>(raise));
+    const __m128i down = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lower));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_subs_epu8(_mm_adds_epu8(pixel, up), down));
+    }
+    dither_row_scalar(pixels + i, count - i, raise, lower, out + i);
+}
+
+__attribute__((target("sse4.1"))) static int match_block_sse4(const uint8_t *block, const uint8_t *templates,
+                                                              int count) {
+    const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16));
+    int best = 0, best_sad = INT32_MAX;
+    for (int glyph = 0; glyph < count; ++glyph) {
+        const uint8_t *shape = templates + glyph * GLYPH_BLOCK_SIZE;
+        // psadbw leaves one sum per 64-bit half
+        __m128i sums = _mm_add_epi64(
+            _mm_sad_epu8(low, _mm_loadu_si128(reinterpret_cast<const __m128i *>(shape))),
+            _mm_sad_epu8(high, _mm_loadu_si128(reinterpret_cast<const __m128i *>(shape + 16))));
+        int sad = _mm_cvtsi128_si32(sums) + _mm_extract_epi32(sums, 2);
+        if (sad < best_sad) {
+            best_sad = sad;
+            best = glyph;
+        }
+    }
+    return best;
+}
+
+__attribute__((target("sse4.1"))) static uint64_t sum_abs_diff_sse4(const uint8_t *a, const uint8_t *b, int count) {
+    __m128i sums = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i))));
+    }
+    // A 64-bit lane sums at most count / 2 * 255, below 2^32 for count up to 2^25, so
+    // its low half is enough and the reduction also works on 32-bit x86
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(sums))) +
+           static_cast<uint32_t>(_mm_extract_epi32(sums, 2)) + sum_abs_diff_scalar(a + i, b + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void map_row_avx2(const uint8_t *pixels, int count,
+                                                        const GlyphTable &table, char *out) {
+    if (table.runs > GLYPH_TABLE_MAX_RUNS) {
+        map_row_scalar(pixels, count, table, out);
+        return;
+    }
+    // vpshufb looks up within each 128-bit lane, so both lanes get the full table
+    const __m256i glyphs = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(table.run_glyphs)));
+    __m256i starts[GLYPH_TABLE_MAX_RUNS];
+    for (int run = 1; run < table.runs; ++run) {
+        starts[run] = _mm256_set1_epi8(static_cast<char>(table.run_starts[run]));
+    }
+
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + i));
+        __m256i index = _mm256_setzero_si256();
+        for (int run = 1; run < table.runs; ++run) {
+            index = _mm256_sub_epi8(index, _mm256_cmpeq_epi8(_mm256_max_epu8(pixel, starts[run]), pixel));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_shuffle_epi8(glyphs, index));
+    }
+    map_row_sse4(pixels + i, count - i, table, out + i);
+}
+
+__attribute__((target("avx2"))) static void min_max_avx2(const uint8_t *pixels, int count,
+                                                        uint8_t &min_value, uint8_t &max_value) {
+    __m256i min_acc = _mm256_set1_epi8(static_cast<char>(min_value));
+    __m256i max_acc = _mm256_set1_epi8(static_cast<char>(max_value));
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + i));
+        min_acc = _mm256_min_epu8(min_acc, pixel);
+        max_acc = _mm256_max_epu8(max_acc, pixel);
+    }
+    alignas(32) uint8_t mins[32], maxs[32];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(mins), min_acc);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(maxs), max_acc);
+    min_value = *std::min_element(mins, mins + 32);
+    max_value = *std::max_element(maxs, maxs + 32);
+    min_max_sse4(pixels + i, count - i, min_value, max_value);
+}
+
+__attribute__((target("avx2"))) static void dither_row_avx2(const uint8_t *pixels, int count, const uint8_t *raise,
+                                                           const uint8_t *lower, uint8_t *out) {
+    const __m256i up = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(raise));
+    const __m256i down = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lower));
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                            _mm256_subs_epu8(_mm256_adds_epu8(pixel, up), down));
+    }
+    dither_row_sse4(pixels + i, count - i, raise, lower, out + i);
+}
+
+__attribute__((target("avx2"))) static int match_block_avx2(const uint8_t *block, const uint8_t *templates,
+                                                            int count) {
+    const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    int best = 0, best_sad = INT32_MAX;
+    for (int glyph = 0; glyph < count; ++glyph) {
+        __m256i sums = _mm256_sad_epu8(
+            samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(templates + glyph * GLYPH_BLOCK_SIZE)));
+        __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        int sad = _mm_cvtsi128_si32(halves) + _mm_extract_epi32(halves, 2);
+        if (sad < best_sad) {
+            best_sad = sad;
+            best = glyph;
+        }
+    }
+    return best;
+}
+
+__attribute__((target("avx2"))) static uint64_t sum_abs_diff_avx2(const uint8_t *a, const uint8_t *b, int count) {
+    __m256i sums = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        sums = _mm256_add_epi64(sums,
+                                _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))));
+    }
+    __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(halves))) +
+           static_cast<uint32_t>(_mm_extract_epi32(halves, 2)) + sum_abs_diff_sse4(a + i, b + i, count - i);
+}
+
+#endif /* GLYPH_KERNELS_X86 */
+
+#ifdef GLYPH_KERNELS_NEON
+
+static void map_row_neon(const uint8_t *pixels, int count, const GlyphTable &table, char *out) {
+    if (table.runs > GLYPH_TABLE_MAX_RUNS) {
+        map_row_scalar(pixels, count, table, out);
+        return;
+    }
+    const uint8x16_t glyphs = vld1q_u8(table.run_glyphs);
+    uint8x16_t starts[GLYPH_TABLE_MAX_RUNS];
+    for (int run = 1; run < table.runs; ++run) {
+        starts[run] = vdupq_n_u8(table.run_starts[run]);
+    }
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t pixel = vld1q_u8(pixels + i);
+        uint8x16_t index = vdupq_n_u8(0);
+        for (int run = 1; run < table.runs; ++run) {
+            index = vsubq_u8(index, vcgeq_u8(pixel, starts[run]));
+        }
+        vst1q_u8(reinterpret_cast<uint8_t *>(out + i), vqtbl1q_u8(glyphs, index));
+    }
+    map_row_scalar(pixels + i, count - i, table, out + i);
+}
+
+static void min_max_neon(const uint8_t *pixels, int count, uint8_t &min_value, uint8_t &max_value) {
+    uint8x16_t min_acc = vdupq_n_u8(min_value);
+    uint8x16_t max_acc = vdupq_n_u8(max_value);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t pixel = vld1q_u8(pixels + i);
+        min_acc = vminq_u8(min_acc, pixel);
+        max_acc = vmaxq_u8(max_acc, pixel);
+    }
+    min_value = vminvq_u8(min_acc);
+    max_value = vmaxvq_u8(max_acc);
+    min_max_scalar(pixels + i, count - i, min_value, max_value);
+}
+
+static void dither_row_neon(const uint8_t *pixels, int count, const uint8_t *raise, const uint8_t *lower,
+                            uint8_t *out) {
+    const uint8x16_t up = vld1q_u8(raise);
+    const uint8x16_t down = vld1q_u8(lower);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(out + i, vqsubq_u8(vqaddq_u8(vld1q_u8(pixels + i), up), down));
+    }
+    dither_row_scalar(pixels + i, count - i, raise, lower, out + i);
+}
+
+static int match_block_neon(const uint8_t *block, const uint8_t *templates, int count) {
+    const uint8x16_t low = vld1q_u8(block);
+    const uint8x16_t high = vld1q_u8(block + 16);
+    int best = 0, best_sad = INT32_MAX;
+    for (int glyph = 0; glyph < count; ++glyph) {
+        const uint8_t *shape = templates + glyph * GLYPH_BLOCK_SIZE;
+        int sad = vaddlvq_u8(vabdq_u8(low, vld1q_u8(shape))) + vaddlvq_u8(vabdq_u8(high, vld1q_u8(shape + 16)));
+        if (sad < best_sad) {
+            best_sad = sad;
+            best = glyph;
+        }
+    }
+    return best;
+}
+
+static uint64_t sum_abs_diff_neon(const uint8_t *a, const uint8_t *b, int count) {
+    uint32x4_t sums = vdupq_n_u32(0);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sums = vpadalq_u16(sums, vpaddlq_u8(vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i))));
+    }
+    return vaddvq_u32(sums) + sum_abs_diff_scalar(a + i, b + i, count - i);
+}
+
+#endif /* GLYPH_KERNELS_NEON */
+
+struct GlyphKernels {
+    void (*map_row)(const uint8_t *, int, const GlyphTable &, char *);
+    void (*min_max)(const uint8_t *, int, uint8_t &, uint8_t &);
+    void (*dither_row)(const uint8_t *, int, const uint8_t *, const uint8_t *, uint8_t *);
+    int (*match_block)(const uint8_t *, const uint8_t *, int);
+    uint64_t (*sum_abs_diff)(const uint8_t *, const uint8_t *, int);
+    const char *name;
+};
+
+static GlyphKernels select_glyph_kernels() {
+#if defined(GLYPH_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {map_row_avx2, min_max_avx2, dither_row_avx2, match_block_avx2, sum_abs_diff_avx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return {map_row_sse4, min_max_sse4, dither_row_sse4, match_block_sse4, sum_abs_diff_sse4, "sse4.1"};
+    }
+#elif defined(GLYPH_KERNELS_NEON)
+    return {map_row_neon, min_max_neon, dither_row_neon, match_block_neon, sum_abs_diff_neon, "neon"};
+#endif
+    return {map_row_scalar, min_max_scalar, dither_row_scalar, match_block_scalar, sum_abs_diff_scalar, "scalar"};
+}
+
+// Picked once on first use
+static const GlyphKernels &glyph_kernels() {
+    static const GlyphKernels kernels = select_glyph_kernels();
+    return kernels;
+}
+
+void map_row_to_glyphs(const uint8_t *pixels, int count, const GlyphTable &table, char *out) {
+    glyph_kernels().map_row(pixels, count, table, out);
+}
+
+void min_max_pixels(const uint8_t *pixels, int count, uint8_t &min_value, uint8_t &max_value) {
+    glyph_kernels().min_max(pixels, count, min_value, max_value);
+}
+
+void dither_row(const uint8_t *pixels, int count, const uint8_t *raise, const uint8_t *lower, uint8_t *out) {
+    glyph_kernels().dither_row(pixels, count, raise, lower, out);
+}
+
+int match_glyph_block(const uint8_t *block, const uint8_t *templates, int count) {
+    return glyph_kernels().match_block(block, templates, count);
+}
+
+uint64_t sum_abs_diff(const uint8_t *a, const uint8_t *b, int count) {
+    return glyph_kernels().sum_abs_diff(a, b, count);
+}
+
+const char *glyph_kernel_name() {
+    return glyph_kernels().name;
+}
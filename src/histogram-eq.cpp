@@ -0,0 +1,114 @@
+//
+//  histogram-eq.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/histogram-eq.hpp"
+
+#include "cmd-media-player/render-basic.hpp"
+
+void count_pixels(const uint8_t *pixels, int count, PixelHistogram &histogram) {
+    for (int i = 0; i < count; ++i) {
+        histogram[pixels[i]]++;
+    }
+}
+
+void HistogramEqualizer::update(const PixelHistogram &histogram) {
+    uint64_t total = 0;
+    for (uint32_t bin : histogram) {
+        total += bin;
+    }
+    if (total == 0) {
+        return;
+    }
+
+    // Clip points from the real histogram
+    int low = 0, high = 255;
+    uint64_t cumulative = 0;
+    for (int value = 0; value < 256; ++value) {
+        cumulative += histogram[value];
+        if (cumulative < EQ_CLIP_LOW * total) {
+            low = value + 1;
+        }
+        if (cumulative < EQ_CLIP_HIGH * total) {
+            high = value + 1;
+        }
+    }
+    high = std::min(high, 255);
+
+    // Cap the bins so a large flat area does not take the whole range, the excess is spread evenly
+    double limit = std::max(1.0, EQ_BIN_LIMIT * total / 256.0);
+    double excess = 0.0;
+    for (uint32_t bin : histogram) {
+        excess += std::max(0.0, bin - limit);
+    }
+    std::array<double, 256> limited_cdf;
+    double sum = 0.0;
+    for (int value = 0; value < 256; ++value) {
+        sum += std::min<double>(histogram[value], limit) + excess / 256.0;
+        limited_cdf[value] = sum;
+    }
+
+    std::array<float, 256> target;
+    double span = limited_cdf[high] - limited_cdf[low];
+    for (int value = 0; value < 256; ++value) {
+        if (value <= low) {
+            target[value] = 0.0f;
+        } else if (value >= high) {
+            target[value] = 255.0f;
+        } else {
+            target[value] = static_cast<float>(span > 0.0 ? (limited_cdf[value] - limited_cdf[low]) * 255.0 / span
+                                                          : (value - low) * 255.0 / (high - low));
+        }
+    }
+
+    // Follow the target slowly, unless the picture changed too much to be the same scene
+    double moved = 0.0;
+    std::array<float, 256> shares;
+    for (int value = 0; value < 256; ++value) {
+        shares[value] = static_cast<float>(histogram[value]) / total;
+        moved += std::fabs(shares[value] - previous[value]);
+    }
+    if (!primed || moved / 2.0 > EQ_SCENE_CUT) {
+        curve = target;
+    } else {
+        for (int value = 0; value < 256; ++value) {
+            curve[value] += EQ_SMOOTHING * (target[value] - curve[value]);
+        }
+    }
+    previous = shares;
+    primed = true;
+}
+
+// Only the render thread converts, and reset_equalizer() starts it over for every new timeline
+static HistogramEqualizer equalizer;
+
+void reset_equalizer() {
+    equalizer.reset();
+}
+
+void image_to_ascii_equalized(const cv::Mat &image, int pre_space, const char *asciiChars, std::string &asciiImage) {
+    if (!equalizer.ready()) {
+        // Nothing to go by on the first frame, count it up front
+        PixelHistogram histogram = {};
+        for (int row = 0; row < image.rows; ++row) {
+            count_pixels(image.ptr<uchar>(row), image.cols, histogram);
+        }
+        equalizer.update(histogram);
+    }
+
+    // Fold the curve into this frame's table, like the stretch of image_to_ascii_dy_contrast
+    const GlyphTable &base_table = glyph_table_for(asciiChars);
+    std::array<char, 256> lut;
+    for (int pixel = 0; pixel < 256; ++pixel) {
+        lut[pixel] = base_table.lut[equalizer.value(pixel)];
+    }
+    GlyphTable table;
+    build_glyph_table(lut, table);
+
+    PixelHistogram histogram = {};
+    map_pixels_to_ascii(image, pre_space, table, asciiImage, &histogram);
+    equalizer.update(histogram);
+}
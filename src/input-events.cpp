@@ -0,0 +1,207 @@
+//
+//  input-events.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/input-events.hpp"
+#include "cmd-media-player/player-basic.hpp"
+
+#ifdef _WIN32
+#error "The input event thread needs POSIX poll() and signals, Windows is not supported"
+#endif
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// Bytes sent through the self-pipe
+#define WAKE_RESIZE 'w'
+#define WAKE_INTERRUPT 'i'
+#define WAKE_STOP 's'
+
+// Write end of the running thread's self-pipe, read by the signal handlers
+static volatile sig_atomic_t wake_fd = -1;
+static struct sigaction previous_winch_action;
+
+static void post_wake(char reason) {
+    int fd = wake_fd;
+    if (fd >= 0) {
+        int saved_errno = errno;
+        ssize_t ignored = write(fd, &reason, 1); // A full pipe already has a wake-up pending
+        (void)ignored;
+        errno = saved_errno;
+    }
+}
+
+static void handle_sigwinch(int sig) {
+    post_wake(WAKE_RESIZE);
+}
+
+void post_input_interrupt() {
+    post_wake(WAKE_INTERRUPT);
+}
+
+static UserAction action_for_key(unsigned char key) {
+    switch (key) {
+        case 3: // Ctrl+C
+            return UserAction::Quit;
+        case ' ':
+            return UserAction::KeySpace;
+        case '=':
+            return UserAction::KeyEqual;
+        case '-':
+            return UserAction::KeyMinus;
+        default:
+            return UserAction::None;
+    }
+}
+
+// Post the actions of the keys in `bytes`, returns how many bytes were used.
+// An escape sequence cut off at the end is left over, unless `flush` is set.
+static size_t decode_keys(const unsigned char *bytes, size_t len, bool flush, ActionQueue &actions) {
+    size_t i = 0;
+    while (i < len) {
+        if (bytes[i] != 27) {
+            UserAction action = action_for_key(bytes[i++]);
+            if (action != UserAction::None) {
+                actions.try_push(action);
+            }
+            continue;
+        }
+        if (i + 1 == len) {
+            if (!flush) {
+                break;
+            }
+            actions.try_push(UserAction::Quit); // A lone ESC key
+            i++;
+            continue;
+        }
+        if (bytes[i + 1] != '[' && bytes[i + 1] != 'O') {
+            actions.try_push(UserAction::Quit);
+            i++;
+            continue;
+        }
+        // CSI (ESC [) or SS3 (ESC O, arrows in keypad mode) sequence, runs up to a final byte
+        size_t end = i + 2;
+        while (end < len && (bytes[end] < 0x40 || bytes[end] > 0x7e)) {
+            end++;
+        }
+        if (end == len) {
+            if (!flush) {
+                break;
+            }
+            i = len;
+            continue;
+        }
+        switch (bytes[end]) {
+            case 'A':
+                actions.try_push(UserAction::KeyUp);
+                break;
+            case 'B':
+                actions.try_push(UserAction::KeyDown);
+                break;
+            case 'C':
+                actions.try_push(UserAction::KeyRight);
+                break;
+            case 'D':
+                actions.try_push(UserAction::KeyLeft);
+                break;
+            default:
+                break;
+        }
+        i = end + 1;
+    }
+    return i;
+}
+
+bool InputEventThread::start() {
+    if (thread.joinable() || pipe(wake_pipe) < 0) {
+        return false;
+    }
+    fcntl(wake_pipe[1], F_SETFL, fcntl(wake_pipe[1], F_GETFL) | O_NONBLOCK);
+    wake_fd = wake_pipe[1];
+
+    struct sigaction action = {};
+    action.sa_handler = handle_sigwinch;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGWINCH, &action, &previous_winch_action);
+
+    enable_terminal_size_cache(true);
+    thread = std::thread(&InputEventThread::run, this);
+    return true;
+}
+
+void InputEventThread::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+    post_wake(WAKE_STOP);
+    thread.join();
+    sigaction(SIGWINCH, &previous_winch_action, nullptr);
+    wake_fd = -1;
+    enable_terminal_size_cache(false);
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    wake_pipe[0] = wake_pipe[1] = -1;
+}
+
+InputEventThread::~InputEventThread() {
+    stop();
+}
+
+void InputEventThread::run() {
+    unsigned char buffer[64];
+    size_t pending = 0; // Bytes of an unfinished escape sequence
+    pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {wake_pipe[0], POLLIN, 0}};
+
+    while (true) {
+        // With part of a sequence buffered, only wait a moment for the rest of it
+        int ready = poll(fds, 2, pending > 0 ? INPUT_ESCAPE_TIMEOUT_MS : -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (ready == 0) {
+            decode_keys(buffer, pending, true, actions);
+            pending = 0;
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char reasons[16];
+            ssize_t count = read(wake_pipe[0], reasons, sizeof(reasons));
+            for (ssize_t i = 0; i < count; ++i) {
+                if (reasons[i] == WAKE_STOP) {
+                    return;
+                } else if (reasons[i] == WAKE_INTERRUPT) {
+                    actions.try_push(UserAction::Quit);
+                } else if (reasons[i] == WAKE_RESIZE) {
+                    update_terminal_size_cache();
+                    actions.try_push(UserAction::Resize);
+                }
+            }
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t count = read(STDIN_FILENO, buffer + pending, sizeof(buffer) - pending);
+            if (count <= 0) {
+                if (count == 0 || (errno != EINTR && errno != EAGAIN)) {
+                    fds[0].fd = -1; // stdin is gone, keep serving signals only
+                }
+                continue;
+            }
+            pending += count;
+            size_t used = decode_keys(buffer, pending, pending == sizeof(buffer), actions);
+            memmove(buffer, buffer + used, pending - used);
+            pending -= used;
+        }
+    }
+}
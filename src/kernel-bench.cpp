@@ -0,0 +1,406 @@
+//
+//  kernel-bench.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+// Micro-benchmarks of the rendering kernels on synthetic frames.
+// With --check it instead compares the converters with a plain reference
+// implementation of the glyph mapping, and fails on any difference.
+
+#include "cmd-media-player/render-basic.hpp"
+
+#include <cstdio>
+
+#define BENCH_MIN_SECONDS 0.2 // Per case
+#define BENCH_MIN_RUNS 20
+#define BENCH_MIX_BYTES 4096  // One audio callback
+
+struct GridSize {
+    int columns;
+    int rows;
+};
+
+// Terminal sizes to run at, odd widths exercise the kernel tails and the largest one the row bands
+static const GridSize GRID_SIZES[] = {{80, 24}, {163, 48}, {320, 96}, {480, 144}};
+
+struct BenchResult {
+    double mean;
+    double p99;
+};
+
+// Time `fn` until enough runs have been collected
+template <typename Fn>
+static BenchResult run_bench(Fn &&fn) {
+    for (int i = 0; i < 3; ++i) {
+        fn(); // Warm up caches and lazily built tables
+    }
+    std::vector<double> samples;
+    double total = 0.0;
+    while (total < BENCH_MIN_SECONDS || samples.size() < BENCH_MIN_RUNS) {
+        double start = clock_seconds();
+        fn();
+        double elapsed = clock_seconds() - start;
+        samples.push_back(elapsed);
+        total += elapsed;
+    }
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.99));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return {total / samples.size(), samples[index]};
+}
+
+static void report(const std::string &name, const BenchResult &result, double cells) {
+    printf("%-44s %10.2f us %10.2f us", name.c_str(), result.mean * 1e6, result.p99 * 1e6);
+    if (cells > 0) {
+        printf(" %9.1f Mcell/s", cells / result.mean / 1e6);
+    }
+    printf("\n");
+}
+
+// Gray frame with gradients, a few flat areas and noise from a fixed seed
+static cv::Mat synthetic_frame(int width, int height, uint32_t seed) {
+    cv::Mat image(height, width, CV_8UC1);
+    uint32_t state = seed * 2654435761u + 1;
+    for (int y = 0; y < height; ++y) {
+        uint8_t *row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < width; ++x) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            int value = (x * 255 / std::max(width - 1, 1) + y * 64 / std::max(height, 1)) % 256;
+            if ((x / 16 + y / 8) % 5 == 0) {
+                value = 40; // Flat block
+            }
+            row[x] = static_cast<uint8_t>(std::clamp(value + static_cast<int>(state % 33) - 16, 0, 255));
+        }
+    }
+    return image;
+}
+
+// The glyph mapping written out the slow, obvious way
+static std::string reference_ascii(const cv::Mat &image, int pre_space, const char *chars, bool dynamic) {
+    size_t length = strlen(chars);
+    int min_pixel = 0, range = 0;
+    if (dynamic) {
+        double min_value, max_value;
+        cv::minMaxLoc(image, &min_value, &max_value);
+        min_pixel = static_cast<int>(min_value);
+        range = static_cast<int>(max_value) - min_pixel;
+    }
+    std::string out;
+    for (int y = 0; y < image.rows; ++y) {
+        out.append(pre_space, ' ');
+        for (int x = 0; x < image.cols; ++x) {
+            int pixel = image.at<uint8_t>(y, x);
+            if (range > 0) {
+                pixel = std::clamp((pixel - min_pixel) * 255 / range, 0, 255);
+            }
+            out += length ? chars[(pixel * length) / 256] : ' ';
+        }
+        if (pre_space) {
+            out += '\n';
+        }
+    }
+    return out;
+}
+
+// Error diffusion one pixel at a time, with the same integer arithmetic as the converters
+static std::string reference_diffused(const cv::Mat &image, int pre_space, const char *chars, bool atkinson) {
+    const int levels = static_cast<int>(strlen(chars));
+    const int denominator = atkinson ? 8 : 16;
+    // Error numerators still to arrive at each pixel, with room for what falls off the edges
+    std::vector<std::vector<int>> errors(image.rows + 2, std::vector<int>(image.cols + 3, 0));
+    std::string out;
+    for (int y = 0; y < image.rows; ++y) {
+        out.append(pre_space, ' ');
+        for (int x = 0; x < image.cols; ++x) {
+            int value = std::clamp(image.at<uint8_t>(y, x) + errors[y][x + 1] / denominator, 0, 255);
+            int level = (value * (levels - 1) + 127) / 255;
+            int error = value - level * 255 / (levels - 1);
+            out += chars[level];
+            if (atkinson) {
+                for (int *target : {&errors[y][x + 2], &errors[y][x + 3], &errors[y + 1][x], &errors[y + 1][x + 1],
+                                    &errors[y + 1][x + 2], &errors[y + 2][x + 1]}) {
+                    *target += error;
+                }
+            } else {
+                errors[y][x + 2] += 7 * error;
+                errors[y + 1][x] += 3 * error;
+                errors[y + 1][x + 1] += 5 * error;
+                errors[y + 1][x + 2] += error;
+            }
+        }
+        if (pre_space) {
+            out += '\n';
+        }
+    }
+    return out;
+}
+
+static int run_checks() {
+    struct Converter {
+        const char *name;
+        AsciiConverter convert;
+        bool dynamic;
+    };
+    const Converter converters[] = {{"st", image_to_ascii, false}, {"dy", image_to_ascii_dy_contrast, true}};
+
+    int cases = 0, failures = 0;
+    for (const GridSize &size : GRID_SIZES) {
+        for (uint32_t seed = 1; seed <= 3; ++seed) {
+            cv::Mat image = synthetic_frame(size.columns, size.rows - 2, seed);
+            cv::Mat narrow = image(cv::Rect(0, 0, size.columns / 2 + 1, size.rows - 2)); // Strided rows
+            for (const cv::Mat &frame : {image, narrow}) {
+                for (const std::string &chars : ascii_char_sets) {
+                    for (const Converter &converter : converters) {
+                        for (int pre_space : {0, 3}) {
+                            std::string output = "prefix"; // Converters must append
+                            converter.convert(frame, pre_space, chars.c_str(), output);
+                            std::string expected = "prefix" + reference_ascii(frame, pre_space, chars.c_str(), converter.dynamic);
+                            cases++;
+                            if (output != expected) {
+                                failures++;
+                                printf("FAIL %s %dx%d seed %u chars \"%s\" pre_space %d\n", converter.name,
+                                       frame.cols, frame.rows, seed, chars.c_str(), pre_space);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    // Error diffusion against the serial reference. The largest grid takes the pipelined
+    // path with rows on the band pool, so it runs a few times to give a race room to show.
+    for (const GridSize &size : GRID_SIZES) {
+        cv::Mat image = synthetic_frame(size.columns, size.rows - 2, 6);
+        bool pipelined = row_band_count(image.rows, static_cast<int64_t>(image.total())) > 1;
+        for (const std::string &chars : ascii_char_sets) {
+            for (bool atkinson : {false, true}) {
+                std::string expected = reference_diffused(image, 2, chars.c_str(), atkinson);
+                for (int run = 0; run < (pipelined ? 10 : 1); ++run) {
+                    std::string output;
+                    (atkinson ? image_to_ascii_atkinson : image_to_ascii_floyd_steinberg)(image, 2, chars.c_str(), output);
+                    cases++;
+                    if (output != expected) {
+                        failures++;
+                        printf("FAIL %s %dx%d chars \"%s\"%s\n", atkinson ? "atkinson" : "floyd_steinberg", image.cols,
+                               image.rows, chars.c_str(), pipelined ? " pipelined" : "");
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Shape matching against a plain SAD search, on blocks built from the atlas plus noise
+    const GlyphAtlas &atlas = glyph_atlas();
+    const int glyph_count = static_cast<int>(atlas.glyphs.size());
+    uint32_t state = 12345;
+    for (int i = 0; i < 2000; ++i) {
+        uint8_t block[GLYPH_BLOCK_SIZE];
+        const uint8_t *base = atlas.templates.data() + (i % glyph_count) * GLYPH_BLOCK_SIZE;
+        for (int j = 0; j < GLYPH_BLOCK_SIZE; ++j) {
+            state = state * 1103515245 + 12345;
+            block[j] = static_cast<uint8_t>(std::clamp(base[j] + static_cast<int>(state >> 16) % 301 - 150, 0, 255));
+        }
+        int expected = 0, best_sad = INT32_MAX;
+        for (int glyph = 0; glyph < glyph_count; ++glyph) {
+            int sad = 0;
+            for (int j = 0; j < GLYPH_BLOCK_SIZE; ++j) {
+                sad += std::abs(block[j] - atlas.templates[glyph * GLYPH_BLOCK_SIZE + j]);
+            }
+            if (sad < best_sad) {
+                best_sad = sad;
+                expected = glyph;
+            }
+        }
+        cases++;
+        if (match_glyph_block(block, atlas.templates.data(), glyph_count) != expected) {
+            failures++;
+            printf("FAIL match_glyph_block case %d\n", i);
+        }
+    }
+    // Dither offsets against a plain loop, split into raise and lower patterns of period 16
+    // as the kernel requires
+    uint8_t raise[DITHER_PATTERN_SIZE], lower[DITHER_PATTERN_SIZE];
+    for (int j = 0; j < DITHER_PATTERN_SIZE; ++j) {
+        state = state * 1103515245 + 12345;
+        int offset = static_cast<int>(state >> 16) % 511 - 255;
+        raise[j] = j < 16 ? static_cast<uint8_t>(std::max(offset, 0)) : raise[j - 16];
+        lower[j] = j < 16 ? static_cast<uint8_t>(std::max(-offset, 0)) : lower[j - 16];
+    }
+    for (int count : {0, 1, 15, 17, 31, 33, 47, 161, 1000}) {
+        std::vector<uint8_t> pixels(count), out(count);
+        for (int j = 0; j < count; ++j) {
+            state = state * 1103515245 + 12345;
+            pixels[j] = static_cast<uint8_t>(state >> 16);
+        }
+        dither_row(pixels.data(), count, raise, lower, out.data());
+        int wrong = 0;
+        for (int j = 0; j < count; ++j) {
+            int expected = std::clamp(pixels[j] + raise[j % DITHER_PATTERN_SIZE] - lower[j % DITHER_PATTERN_SIZE], 0, 255);
+            wrong += out[j] != expected;
+        }
+        cases++;
+        if (wrong) {
+            failures++;
+            printf("FAIL dither_row count %d\n", count);
+        }
+    }
+
+    // Frame differences against a plain loop, odd lengths exercise the tails
+    for (int count : {0, 1, 15, 31, 33, 161, 1000}) {
+        std::vector<uint8_t> a(count), b(count);
+        uint64_t expected = 0;
+        for (int j = 0; j < count; ++j) {
+            state = state * 1103515245 + 12345;
+            a[j] = static_cast<uint8_t>(state >> 16);
+            b[j] = static_cast<uint8_t>(state >> 24);
+            expected += std::abs(a[j] - b[j]);
+        }
+        cases++;
+        if (sum_abs_diff(a.data(), b.data(), count) != expected) {
+            failures++;
+            printf("FAIL sum_abs_diff count %d\n", count);
+        }
+    }
+
+    printf("%d/%d kernel checks passed (%s kernels)\n", cases - failures, cases, glyph_kernel_name());
+    return failures ? 1 : 0;
+}
+
+static void run_benchmarks() {
+    printf("Glyph kernels: %s\n\n", glyph_kernel_name());
+    printf("%-44s %13s %13s\n", "Case", "mean", "p99");
+
+    std::string output;
+    for (const GridSize &size : GRID_SIZES) {
+        cv::Mat image = synthetic_frame(size.columns, size.rows - 2, 1);
+        double cells = static_cast<double>(image.total());
+        std::string grid = std::to_string(size.columns) + "x" + std::to_string(size.rows);
+        for (const std::string &chars : ascii_char_sets) {
+            std::string suffix = " " + grid + " " + std::to_string(chars.size()) + " glyphs";
+            report("image_to_ascii" + suffix, run_bench([&] {
+                       output.clear();
+                       image_to_ascii(image, 0, chars.c_str(), output);
+                   }),
+                   cells);
+            report("image_to_ascii_dy_contrast" + suffix, run_bench([&] {
+                       output.clear();
+                       image_to_ascii_dy_contrast(image, 0, chars.c_str(), output);
+                   }),
+                   cells);
+            report("image_to_ascii_equalized" + suffix, run_bench([&] {
+                       output.clear();
+                       image_to_ascii_equalized(image, 0, chars.c_str(), output);
+                   }),
+                   cells);
+            report("image_to_ascii_bayer" + suffix, run_bench([&] {
+                       output.clear();
+                       image_to_ascii_bayer(image, 0, chars.c_str(), output);
+                   }),
+                   cells);
+            report("image_to_ascii_floyd_steinberg" + suffix, run_bench([&] {
+                       output.clear();
+                       image_to_ascii_floyd_steinberg(image, 0, chars.c_str(), output);
+                   }),
+                   cells);
+        }
+    }
+
+    // Block glyphs into a diff grid, then encoded as UTF-8 with a full repaint
+    FrameDiff diff;
+    for (const GridSize &size : GRID_SIZES) {
+        std::string grid = " " + std::to_string(size.columns) + "x" + std::to_string(size.rows);
+        int rows = size.rows - 2;
+        double cells = static_cast<double>(size.columns) * rows;
+        cv::Mat halves = synthetic_frame(size.columns, rows * 2, 2);
+        report("map_half_blocks" + grid, run_bench([&] {
+                   map_half_blocks(halves, ColorMode::None,
+                                   diff.load_codes(size.columns, rows, &half_block_encoding()), nullptr, size.columns);
+               }),
+               cells);
+        cv::Mat dots = synthetic_frame(size.columns * 2, rows * 4, 3);
+        report("map_braille" + grid, run_bench([&] {
+                   map_braille(dots, ColorMode::None,
+                               diff.load_codes(size.columns, rows, &braille_encoding()), nullptr, size.columns);
+               }),
+               cells);
+        cv::Mat blocks = synthetic_frame(size.columns * GLYPH_CELL_COLUMNS, rows * GLYPH_CELL_ROWS, 4);
+        report("map_shape_glyphs" + grid, run_bench([&] {
+                   map_shape_glyphs(blocks, ColorMode::None, glyph_table_for(ASCII_SEQ_SHORT),
+                                    diff.load_codes(size.columns, rows, nullptr), nullptr, size.columns);
+               }),
+               cells);
+        report("braille as ansi" + grid, run_bench([&] {
+                   output.clear();
+                   diff.invalidate();
+                   diff.append_changes_as_ansi(output);
+               }),
+               cells);
+    }
+
+    // Static frame check on a frame that stays the same, so every row is compared
+    StaticFrameDetector detector;
+    const char *static_chars = ascii_char_sets[0].c_str();
+    for (const GridSize &size : GRID_SIZES) {
+        cv::Mat image = synthetic_frame(size.columns, size.rows - 2, 5);
+        detector.invalidate();
+        detector.unchanged(image, static_chars);
+        report("static frame " + std::to_string(size.columns) + "x" + std::to_string(size.rows),
+               run_bench([&] { detector.unchanged(image, static_chars); }), static_cast<double>(image.total()));
+    }
+
+    std::string bar;
+    for (const GridSize &size : GRID_SIZES) {
+        report("create_progress_bar " + std::to_string(size.columns), run_bench([&] {
+                   bar = create_progress_bar(0.37, size.columns - 20);
+               }),
+               0);
+    }
+
+    // Resize a 1080p YUV frame down to the grid, as the scale stage does
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = 1920;
+    frame->height = 1080;
+    av_frame_get_buffer(frame, 0);
+    for (int plane = 0; plane < 3; ++plane) {
+        int height = plane ? frame->height / 2 : frame->height;
+        cv::Mat pattern = synthetic_frame(frame->linesize[plane], height, plane + 7);
+        memcpy(frame->data[plane], pattern.data, frame->linesize[plane] * height);
+    }
+    FrameScaler scaler;
+    for (const GridSize &size : GRID_SIZES) {
+        FrameLayout layout = layout_frame(frame, size.columns, size.rows);
+        report("scale 1920x1080 -> " + std::to_string(layout.width) + "x" + std::to_string(layout.height),
+               run_bench([&] { scaler.scale(frame, layout.width, layout.height); }),
+               static_cast<double>(layout.width) * layout.height);
+    }
+    av_frame_free(&frame);
+
+    // Audio callback mixing one device buffer out of the queue, refilled each run
+    AudioContext audio_ctx;
+    audio_ctx.queue.init(AUDIO_QUEUE_SIZE);
+    audio_ctx.clock.init(44100 * 2 * 2);
+    std::vector<uint8_t> samples(BENCH_MIX_BYTES);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<uint8_t>(i * 31);
+    }
+    std::vector<Uint8> device(BENCH_MIX_BYTES);
+    report("audio push + mix " + std::to_string(BENCH_MIX_BYTES) + " bytes", run_bench([&] {
+               audio_ctx.queue.push(samples.data(), samples.size());
+               audio_callback(&audio_ctx, device.data(), static_cast<int>(device.size()));
+           }),
+           0);
+    audio_ctx.queue.destroy();
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--check") == 0) {
+        return run_checks();
+    }
+    run_benchmarks();
+    return 0;
+}
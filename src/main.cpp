@@ -5,9 +5,9 @@
 //  Created by Robert He on 2024/9/1.
 //
 
+#include "cmd-media-player/player-bench.hpp"
 #include "cmd-media-player/player-core.hpp"
 
-const std::string VERSION = "1.1.3";
 const std::string UPDATE_DATE = "Jan 31th 2025";
 
 const char *SELF_FILE_NAME;
@@ -111,6 +111,12 @@ void get_command(std::string input = "$DEFAULT") {
         return;
     }
 
+    if (cmdOpts.arguments[0] == "bench") {
+        bench_media(cmdOpts.options);
+        get_command(next_step);
+        return;
+    }
+
     if (cmdOpts.arguments[0] == "exit") {
         return;
     }
@@ -6,6 +6,7 @@
 //
 
 #include "cmd-media-player/player-basic.hpp"
+#include <atomic>
 #include <iostream>
 
 std::string format_time(int64_t seconds) {
@@ -22,7 +23,7 @@ std::string format_time(int64_t seconds) {
 #ifdef _WIN32
 #include <windows.h>
 
-void get_terminal_size(int &width, int &height) {
+static void query_terminal_size(int &width, int &height) {
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) {
         width = csbi.dwSize.X;
@@ -38,7 +39,7 @@ void get_terminal_size(int &width, int &height) {
 #include <sys/ioctl.h>
 #include <unistd.h>
 
-void get_terminal_size(int &width, int &height) {
+static void query_terminal_size(int &width, int &height) {
     struct winsize ws;
     if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0) {
         width = ws.ws_col;
@@ -52,6 +53,33 @@ void get_terminal_size(int &width, int &height) {
 
 #endif
 
+// Size kept by the input thread, which refreshes it on every SIGWINCH
+static std::atomic<bool> terminal_size_cached = false;
+static std::atomic<int> cached_width = 80, cached_height = 24;
+
+void update_terminal_size_cache() {
+    int width, height;
+    query_terminal_size(width, height);
+    cached_width = width;
+    cached_height = height;
+}
+
+void enable_terminal_size_cache(bool enable) {
+    if (enable) {
+        update_terminal_size_cache();
+    }
+    terminal_size_cached = enable;
+}
+
+void get_terminal_size(int &width, int &height) {
+    if (terminal_size_cached) {
+        width = cached_width;
+        height = cached_height;
+    } else {
+        query_terminal_size(width, height);
+    }
+}
+
 const std::string SYS_TYPE = get_system_type();
 
 std::string get_system_type() {
@@ -151,7 +179,7 @@ void show_help_prompt() {
 )";
 }
 
-extern const std::string VERSION; // Declare the version variable
+const std::string VERSION = "1.1.3";
 
 void show_help(bool show_full) {
     std::cout << R"(
@@ -163,6 +191,8 @@ Usage:
     if (show_full) {
         std::cout << R"(Commands:
   play                 Start playing media in this terminal window
+  bench                Decode and render the video as fast as possible
+                        without a terminal and report the throughput
   set                  Set default options (e.g., media path, contrast mode)
   reset                Reset the default options to the initial state
   save                 Save the default options to a configuration file
@@ -175,11 +205,45 @@ Options:
   -dy                  Use dynamic contrast 
                         Scaling the contrast dynamically 
                         based on each frame
+  -ct bayer|fs|atkinson
+                       Dither to hide the banding of short character
+                        sets: ordered (Bayer), Floyd-Steinberg or
+                        Atkinson error diffusion
+  -ct eq               Use histogram equalization, clipped and
+                        smoothed over frames
   -s                   Use short character set "@#*+-:. " (default)
   -l                   Use long character set "@%#*+=^~-;:,'.` "
   -c "sequence"        Set a custom character sequence for ASCII art 
                         (prior to -s and -l)
                         Example: "@%#*+=-:. "
+  --ansi               Write video frames straight to the terminal
+                        with ANSI escapes instead of through ncurses
+  -color 256|truecolor Colour the glyphs with the 256-colour palette
+                        or 24-bit colour (implies --ansi)
+  -glyphs half|braille Draw with half blocks (2 pixels per cell) or
+                        Braille patterns (2x4 dots per cell)
+                        instead of ASCII (implies --ansi)
+  -glyphs shape        Pick the ASCII glyph whose shape matches each
+                        4x8 block of the frame, for sharper edges
+  --threads N|auto     Number of video decoding threads
+                        (default: auto, one per CPU core)
+  --quality auto|fixed Lower the colours, glyphs, resolution and
+                        charset while frames take longer than their
+                        time, and raise them back when there is room
+                        (default: auto)
+  --stats              Show fps, dropped, static frames, quality
+                        steps lowered, A/V offset and audio queue
+                        fill in place of the key hints
+  --static-threshold N|off
+                       Skip frames whose rows differ from the screen
+                        by at most N per pixel on average (default: 1)
+  --trace out.json     Record the time spent in every pipeline stage
+                        as a Chrome trace (chrome://tracing, Perfetto)
+  --bench              Run "play" as "bench"
+  --size COLSxROWS     Virtual terminal size for bench (default: 160x48)
+  --sink PATH          Where bench writes the frames, e.g. a pty
+                        (default: /dev/null)
+  --frames N           Stop bench after N frames
   --version            Show the version of the program
   -h, --help           Show this help message
 
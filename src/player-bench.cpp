@@ -0,0 +1,193 @@
+//
+//  player-bench.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/player-bench.hpp"
+#include "cmd-media-player/render-basic.hpp"
+
+#include <fcntl.h>
+#include <iomanip>
+#include <unistd.h>
+
+// Per-frame latencies of one pipeline stage
+struct StageSamples {
+    const char *name;
+    std::vector<double> seconds;
+
+    double mean() const {
+        double sum = 0.0;
+        for (double value : seconds) {
+            sum += value;
+        }
+        return seconds.empty() ? 0.0 : sum / seconds.size();
+    }
+
+    double percentile(double fraction) const {
+        if (seconds.empty()) {
+            return 0.0;
+        }
+        std::vector<double> sorted = seconds;
+        size_t index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+};
+
+// "COLSxROWS", false if it is not one
+static bool parse_size(const std::string &value, int &columns, int &rows) {
+    return sscanf(value.c_str(), "%dx%d", &columns, &rows) == 2 && columns > 0 && rows > 2;
+}
+
+void bench_media(const std::map<std::string, std::string> &params) {
+    if (!params.count("-m")) {
+        print_error("No media to benchmark, add a -m param");
+        return;
+    }
+    std::string media_path = params.at("-m");
+    AsciiConverter generate_ascii_func = select_ascii_converter(params);
+    select_char_set(params);
+    bool debug_mode = params.count("--debug") > 0;
+
+    int termWidth = BENCH_DEFAULT_COLUMNS, termHeight = BENCH_DEFAULT_ROWS;
+    if (params.count("--size") && !parse_size(params.at("--size"), termWidth, termHeight)) {
+        print_error("Error: --size expects COLSxROWS", params.at("--size"));
+        return;
+    }
+    int64_t frame_limit = 0;
+    if (params.count("--frames")) {
+        frame_limit = std::max<int64_t>(0, atoll(params.at("--frames").c_str()));
+    }
+    std::string sink_path = params.count("--sink") && !params.at("--sink").empty() ? params.at("--sink")
+                                                                                   : BENCH_DEFAULT_SINK;
+
+    avformat_network_init();
+    AVFormatContext *format_ctx = avformat_alloc_context();
+    if (avformat_open_input(&format_ctx, media_path.c_str(), nullptr, nullptr) < 0) {
+        print_error("Error: Could not open video file", media_path);
+        return;
+    }
+    if (avformat_find_stream_info(format_ctx, nullptr) < 0) {
+        avformat_close_input(&format_ctx);
+        print_error("Error: Could not find stream info", media_path);
+        return;
+    }
+
+    VideoContext video_ctx;
+    int thread_count = parse_thread_count(params.count("--threads") ? params.at("--threads") : "auto");
+    GlyphMode glyph_mode = params.count("-glyphs") ? parse_glyph_mode(params.at("-glyphs")) : GlyphMode::Ascii;
+    if (!initialize_video(format_ctx, video_ctx, thread_count, termWidth, termHeight, glyph_mode, debug_mode)) {
+        avformat_close_input(&format_ctx);
+        print_error("Error: No video stream to benchmark", media_path);
+        return;
+    }
+
+    int sink = open(sink_path.c_str(), O_WRONLY | O_NOCTTY);
+    if (sink < 0) {
+        avcodec_free_context(&video_ctx.codec_ctx);
+        avformat_close_input(&format_ctx);
+        print_error("Error: Could not open the output sink", sink_path);
+        return;
+    }
+
+    // Same stages as playback, with the ANSI writer standing in for the terminal
+    RenderContext render_ctx;
+    render_ctx.color_mode = params.count("-color") ? parse_color_mode(params.at("-color")) : ColorMode::None;
+    render_ctx.glyph_mode = glyph_mode;
+    render_ctx.static_frames.set_threshold(
+        parse_static_threshold(params.count("--static-threshold") ? params.at("--static-threshold") : ""));
+    AnsiFrameWriter writer(sink);
+    StageSamples decode_stage = {"decode"}, scale_stage = {"scale"}, ascii_stage = {"ascii"}, output_stage = {"output"};
+    uint64_t output_bytes = 0;
+    int64_t frames = 0;
+    int64_t static_frames = 0; // Not converted nor written, the previous frame still stands
+    reset_equalizer();         // Nothing carries over from an earlier play or bench
+
+    signal(SIGINT, handle_sigint);
+    quit = false;
+
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    double decode_time = 0.0; // Demux and decode work since the last frame came out
+    bool draining = false;
+    double bench_start = clock_seconds();
+
+    while (!quit && (frame_limit == 0 || frames < frame_limit)) {
+        double start = clock_seconds();
+        int ret = avcodec_receive_frame(video_ctx.codec_ctx, frame);
+        if (ret == AVERROR(EAGAIN) && !draining) {
+            if (av_read_frame(format_ctx, packet) < 0) {
+                avcodec_send_packet(video_ctx.codec_ctx, nullptr);
+                draining = true;
+            } else {
+                if (packet->stream_index == video_ctx.stream_index) {
+                    avcodec_send_packet(video_ctx.codec_ctx, packet);
+                }
+                av_packet_unref(packet);
+            }
+            decode_time += clock_seconds() - start;
+            continue;
+        }
+        if (ret < 0) {
+            break; // Drained, or the decoder failed
+        }
+        double decoded = clock_seconds();
+        decode_stage.seconds.push_back(decode_time + decoded - start);
+        decode_time = 0.0;
+
+        FrameLayout layout = layout_frame(frame, termWidth, termHeight);
+        const cv::Mat &image = scale_frame_for_cells(render_ctx, frame, layout);
+        double scaled = clock_seconds();
+        scale_stage.seconds.push_back(scaled - decoded);
+
+        const char *frame_chars = ascii_char_sets[current_char_set_index].c_str();
+        if (render_ctx.static_frames.unchanged(image, frame_chars)) {
+            static_frames++;
+            av_frame_unref(frame);
+            frames++;
+            continue;
+        }
+        load_frame_cells(render_ctx, image, layout, termWidth, termHeight, frame_chars, generate_ascii_func);
+        double converted = clock_seconds();
+        ascii_stage.seconds.push_back(converted - scaled);
+
+        writer.write_frame(render_ctx.diff);
+        output_stage.seconds.push_back(clock_seconds() - converted);
+        output_bytes += writer.last_frame_size();
+
+        av_frame_unref(frame);
+        frames++;
+    }
+    double elapsed = clock_seconds() - bench_start;
+
+    signal(SIGINT, SIG_DFL);
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    close(sink);
+    std::string decoder_info = describe_decoder_threads(video_ctx.codec_ctx);
+    avcodec_free_context(&video_ctx.codec_ctx);
+    avformat_close_input(&format_ctx);
+
+    std::cout << "\nBenchmark: " << media_path << "\n"
+              << "Grid: " << termWidth << "x" << termHeight << ", output to " << sink_path << "\n"
+              << "Video decoder: " << decoder_info << ", glyph kernels: " << glyph_kernel_name() << "\n";
+    if (frames == 0) {
+        std::cout << "No frames decoded" << std::endl;
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(3)
+              << "Frames: " << frames << " in " << elapsed << "s, " << frames / elapsed << " fps\n\n"
+              << std::left << std::setw(10) << "Stage" << std::right << std::setw(12) << "mean (ms)"
+              << std::setw(12) << "p99 (ms)" << "\n";
+    for (const StageSamples *stage : {&decode_stage, &scale_stage, &ascii_stage, &output_stage}) {
+        std::cout << std::left << std::setw(10) << stage->name << std::right
+                  << std::setw(12) << stage->mean() * 1000.0 << std::setw(12) << stage->percentile(0.99) * 1000.0 << "\n";
+    }
+    // Static frames write nothing, so they would only dilute the average
+    int64_t drawn_frames = frames - static_frames;
+    std::cout << "\nOutput: " << (drawn_frames ? output_bytes / drawn_frames : 0) << " bytes per drawn frame, "
+              << output_bytes << " bytes total\n"
+              << "Static: " << static_frames << " of " << frames << " frames skipped" << std::defaultfloat << std::endl;
+}
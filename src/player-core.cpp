@@ -6,6 +6,7 @@
 //
 
 #include "cmd-media-player/player-basic.hpp"
+#include "cmd-media-player/player-bench.hpp"
 #include "cmd-media-player/render-basic.hpp"
 
 const char *ASCII_SEQ_LONGEST = "@%#*+^=~-;:,'.` ";
@@ -45,58 +46,88 @@ void volume_down() {
     adjust_volume(-SDL_MIX_MAXVOLUME / 10);
 }
 
-const std::map<std::string, std::function<std::string(const cv::Mat &, int, const char *)>> param_func_pair = {
+const std::map<std::string, AsciiConverter> param_func_pair = {
     {"dy", image_to_ascii_dy_contrast},
-    {"st", image_to_ascii}};
+    {"st", image_to_ascii},
+    {"bayer", image_to_ascii_bayer},
+    {"fs", image_to_ascii_floyd_steinberg},
+    {"atkinson", image_to_ascii_atkinson},
+    {"eq", image_to_ascii_equalized}};
+
+PlaybackStats playback_stats;
 
 // Global variable to handle Ctrl+C
-bool quit = false;
+std::atomic<bool> quit = false;
 
 // Signal handler for Ctrl+C
 void handle_sigint(int sig) {
     quit = true;
+    post_input_interrupt(); // Wakes up the render loop if it is paused
 }
 
-void control_frame_rate(const std::chrono::high_resolution_clock::time_point &start_time, int frame_delay) {
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-    int remaining_delay = frame_delay - static_cast<int>(processing_time.count()) - 4;
-    if (remaining_delay > 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(remaining_delay));
-    }
+void release_packet_entry(PacketEntry &entry) {
+    av_packet_free(&entry.packet);
 }
 
-void seek_for(int seek_seconds, bool debug_mode, int64_t &current_time, int64_t total_duration,
-              AVFormatContext *format_ctx, AVCodecContext *audio_codec_ctx, AVCodecContext *video_codec_ctx,
-              bool has_audio, bool has_video) {
-    // Calculate the target time
-    int64_t target_time = current_time + seek_seconds;
+void release_frame_entry(FrameEntry &entry) {
+    av_frame_free(&entry.frame);
+}
+
+// Ask the demux thread to seek relative to the current (or already pending) position
+void request_seek(PlaybackState &state, int seek_seconds, int64_t total_duration) {
+    int64_t pending = state.seek_target;
+    int64_t base = pending >= 0 ? pending : state.current_time.load();
 
     // Limit the target time to the range [0, total_duration]
-    target_time = std::clamp(target_time, int64_t(0), int64_t(total_duration));
+    state.seek_target = std::clamp(base + seek_seconds, int64_t(0), int64_t(total_duration));
+}
 
+// Move the playback position to the audio being heard. The decoder runs the whole
+// queue and device buffer ahead of it, so its timestamps are no use for the overlay
+// or as the base of a seek. A clock not yet reset for the current seek is ignored,
+// and a seek that lands meanwhile keeps its target.
+void update_heard_time(PlaybackState &state, const AudioContext &audio_ctx) {
+    int serial = state.serial;
+    double heard_pts;
+    if (audio_ctx.clock_serial != serial || !audio_ctx.clock.now(heard_pts)) {
+        return;
+    }
+    int64_t shown = state.current_time;
+    if (state.serial == serial) {
+        state.current_time.compare_exchange_strong(shown, static_cast<int64_t>(heard_pts));
+    }
+}
+
+// Runs on the demux thread, which is the only one touching format_ctx
+void seek_for(int64_t target_time, bool debug_mode, AVFormatContext *format_ctx, PlaybackState &state,
+              VideoContext &video_ctx, AudioContext &audio_ctx, bool has_audio, bool has_video) {
     // Convert the target time to timestamp
     int64_t target_ts = target_time * AV_TIME_BASE;
 
     // Set the seek flags
     int flags = 0;
-    if (seek_seconds < 0) {
+    if (target_time < state.current_time) {
         flags |= AVSEEK_FLAG_BACKWARD;
     }
 
     // Seek to the target timestamp
     if (av_seek_frame(format_ctx, -1, target_ts, flags) >= 0) {
+        // Everything queued so far belongs to the old position. The decoders flush
+        // their codec buffers once they see a packet carrying the new serial.
+        state.serial++;
+
         // Only flush audio buffers if audio stream exists
-        if (has_audio && audio_codec_ctx) {
-            avcodec_flush_buffers(audio_codec_ctx);
+        if (has_audio) {
+            audio_ctx.packets.flush(release_packet_entry);
         }
 
         // Only flush video buffers if video stream exists
-        if (has_video && video_codec_ctx) {
-            avcodec_flush_buffers(video_codec_ctx);
+        if (has_video) {
+            video_ctx.packets.flush(release_packet_entry);
+            video_ctx.frames.flush(release_frame_entry);
         }
 
-        current_time = target_time;
+        state.current_time = target_time;
     } else {
         if (debug_mode) {
             std::cerr << "Error: Seek operation failed." << std::endl;
@@ -104,8 +135,200 @@ void seek_for(int seek_seconds, bool debug_mode, int64_t &current_time, int64_t
     }
 }
 
-bool initialize_video(AVFormatContext *format_ctx, VideoContext &video_ctx, bool debug_mode) {
-    video_ctx = {nullptr, nullptr, -1, 0.0};
+void demux_loop(AVFormatContext *format_ctx, PlaybackState &state, VideoContext &video_ctx, AudioContext &audio_ctx,
+                bool has_visual, bool has_aural, bool debug_mode) {
+    trace_thread_name("demux");
+    bool eof = false;
+    while (!quit && !state.stop) {
+        int64_t target_time = state.seek_target.exchange(-1);
+        if (target_time >= 0) {
+            seek_for(target_time, debug_mode, format_ctx, state, video_ctx, audio_ctx, has_aural, has_visual);
+            eof = false;
+        }
+
+        if (eof) {
+            // Stay around after the end so that seeking backwards still works
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        AVPacket *packet = av_packet_alloc();
+        int serial = state.serial;
+        double read_start = trace_now();
+        int read_result = av_read_frame(format_ctx, packet);
+        trace_span("demux", read_start);
+        if (read_result < 0) {
+            av_packet_free(&packet);
+            eof = true;
+            if (has_visual) {
+                video_ctx.packets.push({nullptr, serial});
+            }
+            if (has_aural) {
+                audio_ctx.packets.push({nullptr, serial});
+            }
+            continue;
+        }
+
+        PacketQueue *queue = nullptr;
+        if (has_visual && packet->stream_index == video_ctx.stream_index) {
+            queue = &video_ctx.packets;
+        } else if (has_aural && packet->stream_index == audio_ctx.stream_index) {
+            queue = &audio_ctx.packets;
+        }
+
+        // push() blocks while the decoder is behind, which throttles reading
+        if (!queue || !queue->push({packet, serial})) {
+            av_packet_free(&packet);
+        }
+    }
+}
+
+// Trade decoding quality for speed while rendering falls behind
+void apply_skip_level(AVCodecContext *codec_ctx, int level) {
+    static const AVDiscard skip_frame[DECODE_SKIP_MAX_LEVEL + 1] = {
+        AVDISCARD_DEFAULT, AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_NONKEY};
+    codec_ctx->skip_loop_filter = level > 0 ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    codec_ctx->skip_frame = skip_frame[std::clamp(level, 0, DECODE_SKIP_MAX_LEVEL)];
+}
+
+void video_decode_loop(VideoContext &video_ctx) {
+    trace_thread_name("video decode");
+    AVFrame *frame = av_frame_alloc();
+    int serial = 0;
+    int skip_level = 0;
+    PacketEntry entry;
+
+    while (video_ctx.packets.pop(entry)) {
+        if (entry.serial != serial) {
+            avcodec_flush_buffers(video_ctx.codec_ctx);
+            serial = entry.serial;
+        }
+        if (video_ctx.skip_level != skip_level) {
+            skip_level = video_ctx.skip_level;
+            apply_skip_level(video_ctx.codec_ctx, skip_level);
+        }
+
+        // A null packet puts the decoder into draining mode to get the remaining frames out.
+        // The spans leave out the time spent blocked on a full frame queue
+        double decode_start = trace_now();
+        int sent = avcodec_send_packet(video_ctx.codec_ctx, entry.packet);
+        trace_span("video decode", decode_start);
+        if (sent >= 0) {
+            while (true) {
+                decode_start = trace_now();
+                int received = avcodec_receive_frame(video_ctx.codec_ctx, frame);
+                trace_span("video decode", decode_start);
+                if (received < 0) {
+                    break;
+                }
+                AVFrame *decoded = av_frame_alloc();
+                av_frame_move_ref(decoded, frame);
+                if (!video_ctx.frames.push({decoded, serial})) {
+                    av_frame_free(&decoded);
+                    break;
+                }
+            }
+        }
+
+        if (!entry.packet) {
+            video_ctx.frames.push({nullptr, serial});
+        }
+        av_packet_free(&entry.packet);
+    }
+
+    av_frame_free(&frame);
+}
+
+void audio_decode_loop(AudioContext &audio_ctx, PlaybackState &state) {
+    trace_thread_name("audio decode");
+    AVFrame *frame = av_frame_alloc();
+    int serial = 0;
+    PacketEntry entry;
+
+    while (audio_ctx.packets.pop(entry)) {
+        if (entry.serial != serial) {
+            avcodec_flush_buffers(audio_ctx.codec_ctx);
+
+            // Drop the samples that were queued for the old position
+            audio_ctx.queue.flush();
+            audio_ctx.clock.reset();
+            serial = entry.serial;
+            audio_ctx.clock_serial = serial;
+        }
+
+        double decode_start = trace_now();
+        int sent = avcodec_send_packet(audio_ctx.codec_ctx, entry.packet);
+        trace_span("audio decode", decode_start);
+        if (sent >= 0) {
+            while (serial == state.serial) {
+                decode_start = trace_now();
+                int received = avcodec_receive_frame(audio_ctx.codec_ctx, frame);
+                trace_span("audio decode", decode_start);
+                if (received < 0) {
+                    break;
+                }
+                process_audio_frame(frame, audio_ctx, quit);
+            }
+        }
+
+        if (!entry.packet) {
+            audio_ctx.eof_serial = serial;
+        }
+        av_packet_free(&entry.packet);
+    }
+
+    av_frame_free(&frame);
+}
+
+// Largest lowres level of the codec that still leaves enough pixels for every terminal cell,
+// each of which samples `cell_columns` x `cell_rows` pixels
+int choose_lowres(const AVCodec *codec, int width, int height, int termWidth, int termHeight,
+                  int cell_columns, int cell_rows) {
+    int level = 0;
+    while (level < codec->max_lowres &&
+           (width >> (level + 1)) >= termWidth * cell_columns * LOWRES_OVERSAMPLE &&
+           (height >> (level + 1)) >= termHeight * cell_rows * LOWRES_OVERSAMPLE) {
+        level++;
+    }
+    return level;
+}
+
+// Decoder threads for a --threads value: a positive count, or "auto"/anything else for one per core
+int parse_thread_count(const std::string &value) {
+    int count = 0;
+    if (value != "auto") {
+        try {
+            count = std::stoi(value);
+        } catch (const std::exception &) {
+            count = 0;
+        }
+    }
+    if (count <= 0) {
+        // FFmpeg does not scale past 16 decoding threads
+        count = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, 16);
+    }
+    return count;
+}
+
+std::string describe_decoder_threads(const AVCodecContext *codec_ctx) {
+    std::string mode;
+    if (codec_ctx->active_thread_type & FF_THREAD_FRAME) {
+        mode = "frame";
+    } else if (codec_ctx->active_thread_type & FF_THREAD_SLICE) {
+        mode = "slice";
+    } else {
+        mode = "no";
+    }
+    return std::string(avcodec_get_name(codec_ctx->codec_id)) + ", " + std::to_string(codec_ctx->thread_count) +
+           " thread(s), " + mode + " threading";
+}
+
+bool initialize_video(AVFormatContext *format_ctx, VideoContext &video_ctx, int thread_count,
+                      int termWidth, int termHeight, GlyphMode glyph_mode, bool debug_mode) {
+    video_ctx.codec_ctx = nullptr;
+    video_ctx.stream = nullptr;
+    video_ctx.stream_index = -1;
+    video_ctx.fps = 0.0;
 
     // Find video stream
     for (int i = 0; i < format_ctx->nb_streams; ++i) {
@@ -138,6 +361,20 @@ bool initialize_video(AVFormatContext *format_ctx, VideoContext &video_ctx, bool
         return false;
     }
 
+    // The terminal grid is tiny next to most sources, codecs that can decode
+    // at a fraction of the size get to do so. The level is fixed once the codec
+    // is open, so it is picked for the largest grid playback is likely to reach
+    // (the quality governor only ever goes below the starting resolution).
+    video_ctx.codec_ctx->lowres = choose_lowres(video_codec, video_ctx.codec_ctx->width, video_ctx.codec_ctx->height,
+                                               std::max(termWidth, LOWRES_RESERVE_COLUMNS),
+                                               std::max(termHeight, LOWRES_RESERVE_ROWS),
+                                               glyph_mode_columns(glyph_mode), glyph_mode_rows(glyph_mode));
+    video_ctx.skip_level = 0;
+
+    // Let the decoder use frame and slice threading, it picks whichever the codec supports
+    video_ctx.codec_ctx->thread_count = thread_count;
+    video_ctx.codec_ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
     if (avcodec_open2(video_ctx.codec_ctx, video_codec, nullptr) < 0) {
         avcodec_free_context(&video_ctx.codec_ctx);
         if (debug_mode)
@@ -145,12 +382,17 @@ bool initialize_video(AVFormatContext *format_ctx, VideoContext &video_ctx, bool
         return false;
     }
 
-    video_ctx.fps = av_q2d(video_ctx.stream->avg_frame_rate);
+    // Only a first guess at the frame duration, the timestamps drive the schedule.
+    // avg_frame_rate is off for variable frame rate sources, let FFmpeg pick the likelier rate
+    video_ctx.fps = av_q2d(av_guess_frame_rate(format_ctx, video_ctx.stream, nullptr));
     return true;
 }
 
 bool initialize_audio(AVFormatContext *format_ctx, AudioContext &audio_ctx, bool debug_mode) {
-    audio_ctx = {nullptr, nullptr, -1, nullptr, {}, {}};
+    audio_ctx.codec_ctx = nullptr;
+    audio_ctx.stream = nullptr;
+    audio_ctx.stream_index = -1;
+    audio_ctx.swr_ctx = nullptr;
 
     // Find audio stream
     for (int i = 0; i < format_ctx->nb_streams; ++i) {
@@ -169,10 +411,7 @@ bool initialize_audio(AVFormatContext *format_ctx, AudioContext &audio_ctx, bool
     }
 
     // Initialize audio queue with timing information
-    audio_ctx.queue.data = new uint8_t[AUDIO_QUEUE_SIZE];
-    audio_ctx.queue.size = 0;
-    audio_ctx.queue.mutex = SDL_CreateMutex();
-    audio_ctx.queue.current_pts = 0;
+    audio_ctx.queue.init(AUDIO_QUEUE_SIZE);
     audio_ctx.queue.time_base = av_q2d(audio_ctx.stream->time_base);
 
     // Initialize audio codec
@@ -211,7 +450,7 @@ bool initialize_audio(AVFormatContext *format_ctx, AudioContext &audio_ctx, bool
     wanted_spec.silence = 0;
     wanted_spec.samples = 1024;
     wanted_spec.callback = audio_callback;
-    wanted_spec.userdata = &audio_ctx.queue;
+    wanted_spec.userdata = &audio_ctx;
 
     audio_device_id = SDL_OpenAudioDevice(nullptr, 0, &wanted_spec, &audio_ctx.spec, 0);
     if (audio_device_id == 0) {
@@ -219,6 +458,7 @@ bool initialize_audio(AVFormatContext *format_ctx, AudioContext &audio_ctx, bool
             print_error("SDL_OpenAudioDevice Error: ", SDL_GetError());
         return false;
     }
+    audio_ctx.clock.init(static_cast<double>(audio_ctx.spec.freq) * audio_ctx.spec.channels * 2); // S16 samples
 
     // Initialize resampler
     audio_ctx.swr_ctx = swr_alloc();
@@ -252,28 +492,21 @@ bool initialize_audio(AVFormatContext *format_ctx, AudioContext &audio_ctx, bool
     return true;
 }
 
-void play_media(const std::map<std::string, std::string> &params) {
-    std::string media_path;
-    const char *frame_chars;
-    std::function<std::string(const cv::Mat &, int, const char *)> generate_ascii_func = nullptr;
-
-    if (params.count("-m")) {
-        media_path = params.at("-m");
-    } else {
-        print_error("No media but wanna play? Really? \nAdd a -m param, or type \"help\" to get more usage");
-        return;
-    }
-
+// The converter for -ct, -dy or -st, static contrast by default
+AsciiConverter select_ascii_converter(const std::map<std::string, std::string> &params) {
     if (params.count("-ct") && param_func_pair.count(params.at("-ct"))) {
-        generate_ascii_func = param_func_pair.at(params.at("-ct"));
+        return param_func_pair.at(params.at("-ct"));
     } else if (params.count("-dy")) {
-        generate_ascii_func = image_to_ascii_dy_contrast;
+        return image_to_ascii_dy_contrast;
     } else if (params.count("-st")) {
-        generate_ascii_func = image_to_ascii;
+        return image_to_ascii;
     } else {
-        generate_ascii_func = image_to_ascii;
+        return image_to_ascii;
     }
+}
 
+// Pick the charset from -c/-s/-l, a custom one is added to the list in length order
+void select_char_set(const std::map<std::string, std::string> &params) {
     if (params.count("-c") && params.at("-c").length() > 0) {
         std::string custom_chars = params.at("-c");
 
@@ -295,6 +528,27 @@ void play_media(const std::map<std::string, std::string> &params) {
     } else {
         current_char_set_index = 2; // Default: ASCII_SEQ_SHORT
     }
+}
+
+void play_media(const std::map<std::string, std::string> &params) {
+    if (params.count("--bench")) {
+        bench_media(params);
+        return;
+    }
+
+    std::string media_path;
+    const char *frame_chars;
+    AsciiConverter generate_ascii_func = nullptr;
+
+    if (params.count("-m")) {
+        media_path = params.at("-m");
+    } else {
+        print_error("No media but wanna play? Really? \nAdd a -m param, or type \"help\" to get more usage");
+        return;
+    }
+
+    generate_ascii_func = select_ascii_converter(params);
+    select_char_set(params);
 
     bool debug_mode = false;
     if (params.count("--debug")) {
@@ -318,7 +572,13 @@ void play_media(const std::map<std::string, std::string> &params) {
 
     VideoContext video_ctx;
     AudioContext audio_ctx;
-    bool has_visual = initialize_video(format_ctx, video_ctx, debug_mode);
+    int thread_count = parse_thread_count(params.count("--threads") ? params.at("--threads") : "auto");
+    int termWidth, termHeight, prevTermWidth = 0, prevTermHeight = 0;
+    get_terminal_size(termWidth, termHeight);
+    // Known before the decoder opens, it decides how far lowres may go
+    GlyphMode glyph_mode = params.count("-glyphs") ? parse_glyph_mode(params.at("-glyphs")) : GlyphMode::Ascii;
+    bool has_visual =
+        initialize_video(format_ctx, video_ctx, thread_count, termWidth, termHeight, glyph_mode, debug_mode);
     bool has_aural = initialize_audio(format_ctx, audio_ctx, debug_mode);
 
     if (!has_visual && !has_aural) {
@@ -327,8 +587,8 @@ void play_media(const std::map<std::string, std::string> &params) {
         return;
     }
 
-    AVPacket *packet = av_packet_alloc();
-    AVFrame *frame = av_frame_alloc();
+    std::string decoder_info = has_visual ? describe_decoder_threads(video_ctx.codec_ctx) : "none";
+
     AVFrame *last_video_frame = av_frame_alloc();
     bool has_last_frame = false;
 
@@ -336,9 +596,8 @@ void play_media(const std::map<std::string, std::string> &params) {
     std::string total_time = format_time(total_duration);
     int64_t current_time = 0;
 
-    double fps = has_visual ? video_ctx.fps : 30.0; // Use 30fps refresh rate if no video stream
-    int frame_delay = static_cast<int>(1000.0 / fps);
-    int termWidth, termHeight, frameWidth, frameHeight, prevTermWidth = 0, prevTermHeight = 0, w_space_count = 0, h_line_count = 0;
+    double fps = has_visual && video_ctx.fps > 0 ? video_ctx.fps : 30.0; // Use 30fps refresh rate if no video stream
+    double refresh_interval = 1.0 / fps; // Overlay refresh while no video frame is due
 
     NCursesHandler ncursesHandler;
 
@@ -346,13 +605,55 @@ void play_media(const std::map<std::string, std::string> &params) {
     signal(SIGINT, handle_sigint);
     quit = false;
 
+    std::string trace_path = params.count("--trace") ? params.at("--trace") : "";
+    if (!trace_path.empty()) {
+        trace_start(trace_path);
+        trace_thread_name("render");
+    }
+    playback_stats = PlaybackStats();
+    playback_stats.enabled = params.count("--stats") > 0;
+
+    // Demux and decode run on their own threads, this one renders and handles input
+    PlaybackState state;
+    std::thread demuxer(demux_loop, format_ctx, std::ref(state), std::ref(video_ctx), std::ref(audio_ctx),
+                        has_visual, has_aural, debug_mode);
+    if (has_visual) {
+        video_ctx.decoder = std::thread(video_decode_loop, std::ref(video_ctx));
+    }
+    if (has_aural) {
+        audio_ctx.decoder = std::thread(audio_decode_loop, std::ref(audio_ctx), std::ref(state));
+    }
+
+    RenderContext render_ctx;
+    render_ctx.color_mode = params.count("-color") ? parse_color_mode(params.at("-color")) : ColorMode::None;
+    render_ctx.glyph_mode = glyph_mode;
+    // Colour escapes and UTF-8 glyphs go around ncurses, so they always take the ANSI path
+    render_ctx.ansi_output = params.count("--ansi") > 0 || render_ctx.color_mode != ColorMode::None ||
+                             glyph_mode_is_unicode(render_ctx.glyph_mode);
+    render_ctx.static_frames.set_threshold(
+        parse_static_threshold(params.count("--static-threshold") ? params.at("--static-threshold") : ""));
+    // The chosen settings are the top of the ladder, the governor only ever goes below them
+    QualityLevel top_quality;
+    top_quality.glyph_mode = render_ctx.glyph_mode;
+    top_quality.color_mode = render_ctx.color_mode;
+    QualityGovernor quality_governor;
+    bool fixed_quality = params.count("--quality") && params.at("--quality") == "fixed";
+    quality_governor.init(fixed_quality ? std::vector<QualityLevel>{top_quality} : build_quality_ladder(top_quality));
     bool term_size_changed = true;
     int seek_seconds = 3; // Number of seconds to seek
     int no_video_count = 0;
-
-    while (!quit && av_read_frame(format_ctx, packet) >= 0) {
-        bool new_frame_received = false;
-        auto start_time = std::chrono::high_resolution_clock::now();
+    int video_eof_serial = -1;
+    FrameEntry pending = {nullptr, 0}; // Next video frame, waiting for its presentation time
+    int shown_serial = state.serial;   // Of the last frame drawn, a new one means a seek happened
+    reset_equalizer();
+    FrameScheduler frame_scheduler(1.0 / fps);
+    DecodeThrottle decode_throttle;
+
+    while (!quit) {
+        double loop_start = clock_seconds();
+        if (has_aural) {
+            playback_stats.audio_fill = static_cast<double>(audio_ctx.queue.size()) / audio_ctx.queue.capacity;
+        }
         bool force_refresh = true;
 
         switch (ncursesHandler.handleInput()) {
@@ -360,10 +661,10 @@ void play_media(const std::map<std::string, std::string> &params) {
                 quit = true;
                 break;
             case UserAction::KeyLeft:
-                seek_for(-seek_seconds, debug_mode, current_time, total_duration, format_ctx, audio_ctx.codec_ctx, video_ctx.codec_ctx, has_aural, has_visual);
+                request_seek(state, -seek_seconds, total_duration);
                 break;
             case UserAction::KeyRight:
-                seek_for(seek_seconds, debug_mode, current_time, total_duration, format_ctx, audio_ctx.codec_ctx, video_ctx.codec_ctx, has_aural, has_visual);
+                request_seek(state, seek_seconds, total_duration);
                 break;
             case UserAction::KeyEqual:
                 if (current_char_set_index < ascii_char_sets.size() - 1) {
@@ -385,65 +686,168 @@ void play_media(const std::map<std::string, std::string> &params) {
                     volume_down();
                 }
                 break;
+            case UserAction::KeySpace:
+                frame_scheduler.reset(); // Resumed, the paused time must not count as running late
+                force_refresh = false;
+                break;
+            case UserAction::Resize:
+                break;
             default:
                 force_refresh = false;
                 break;
         }
+        if (quit) {
+            break;
+        }
 
-        if (has_visual && packet->stream_index == video_ctx.stream_index &&
-            avcodec_send_packet(video_ctx.codec_ctx, packet) >= 0) {
-            while (avcodec_receive_frame(video_ctx.codec_ctx, frame) >= 0) {
-                new_frame_received = true;
-                no_video_count = 0;
-                if (!has_last_frame) {
-                    av_frame_unref(last_video_frame);
-                    av_frame_ref(last_video_frame, frame);
-                    has_last_frame = true;
+        // Hold on to the next frame until it is due
+        if (!pending.frame && has_visual && video_eof_serial != state.serial) {
+            FrameEntry entry = {nullptr, 0};
+            double wait_start = trace_now();
+            bool popped = video_ctx.frames.pop_for(entry, std::chrono::duration<double>(refresh_interval));
+            trace_span("wait frame", wait_start);
+            if (popped) {
+                if (entry.serial != state.serial) {
+                    // Decoded before the last seek
+                    av_frame_free(&entry.frame);
+                    continue;
                 }
-                const char *frame_chars = ascii_char_sets[current_char_set_index].c_str();
-
-                render_video_frame(frame, video_ctx.stream, packet,
-                                   termWidth, termHeight, prevTermWidth, prevTermHeight,
-                                   term_size_changed, current_time, total_duration, total_time,
-                                   frame_chars, false, ncursesHandler.is_paused, generate_ascii_func);
+                if (!entry.frame) {
+                    video_eof_serial = entry.serial;
+                    continue;
+                }
+                pending = entry;
+            }
+        }
+        if (pending.frame && pending.serial != state.serial) {
+            av_frame_free(&pending.frame);
+            continue;
+        }
 
-                control_frame_rate(start_time, frame_delay);
+        if (pending.frame) {
+            // Schedule against the audio being heard while there is any, otherwise by the frame timestamps
+            bool audio_playing = has_aural && !(audio_ctx.eof_serial == state.serial && audio_ctx.queue.size() == 0);
+            double frame_pts = frame_pts_seconds(pending.frame, video_ctx.stream);
+            double master_pts = 0.0;
+            bool synced = audio_playing && !std::isnan(frame_pts) && audio_ctx.clock.now(master_pts);
+            double now = clock_seconds();
+            double deadline;
+            if (synced) {
+                deadline = now + (frame_pts - master_pts);
+                frame_scheduler.reset(); // Own timeline starts over once the audio is gone
+            } else {
+                deadline = frame_scheduler.deadline(frame_pts, now);
             }
-        } else if (packet->stream_index == audio_ctx.stream_index && audio_ctx.codec_ctx &&
-                   audio_ctx.swr_ctx && avcodec_send_packet(audio_ctx.codec_ctx, packet) >= 0) {
-            while (avcodec_receive_frame(audio_ctx.codec_ctx, frame) >= 0) {
-                process_audio_frame(frame, audio_ctx, quit);
+            double frame_duration = frame_scheduler.frame_duration();
+            double delay = deadline - now;
+
+            // Deadlines are absolute either way, so running behind is made up by skipping work
+            bool late = delay < -frame_duration;
+            video_ctx.skip_level = decode_throttle.update(late, now, video_ctx.skip_level);
+            if (late && video_ctx.frames.size() > 0) {
+                // Too late to be worth converting, and the next frame is already waiting
+                av_frame_free(&pending.frame);
+                playback_stats.dropped_frames++;
+                continue;
+            }
+            if (delay > 0) {
+                // Wait in steps of at most one frame so input stays responsive
+                TraceScope sleep_span("sleep");
+                sleep_until_seconds(std::min(deadline, now + frame_duration));
+                if (delay > frame_duration) {
+                    continue;
+                }
             }
-            if (!new_frame_received) {
-                no_video_count += 1;
-                force_refresh = true;
+            double presented_at = clock_seconds();
+            frame_scheduler.presented(frame_pts, deadline, presented_at);
+            playback_stats.on_frame(presented_at);
+            playback_stats.av_offset = synced ? deadline - presented_at : NAN;
+
+            no_video_count = 0;
+            av_frame_unref(last_video_frame);
+            av_frame_ref(last_video_frame, pending.frame);
+            has_last_frame = true;
+
+            current_time = frame_time_seconds(pending.frame, video_ctx.stream, current_time);
+            state.current_time = current_time;
+            const char *frame_chars =
+                ascii_char_sets[std::min(current_char_set_index, quality_governor.current().char_set_cap)].c_str();
+            if (pending.serial != shown_serial) {
+                // The curve belongs to the old position, the first frame after the seek sets it up again
+                reset_equalizer();
+                shown_serial = pending.serial;
             }
 
-            if (no_video_count > NO_VIDEO_THRESHOLD && has_last_frame && has_aural) {
-                no_video_count -= 5;
-                const char *frame_chars = ascii_char_sets[current_char_set_index].c_str();
-                render_video_frame(last_video_frame, video_ctx.stream, packet,
-                                   termWidth, termHeight, prevTermWidth, prevTermHeight,
-                                   term_size_changed, current_time, total_duration, total_time,
-                                   frame_chars, force_refresh, ncursesHandler.is_paused, generate_ascii_func);
+            render_video_frame(pending.frame, render_ctx,
+                               termWidth, termHeight, prevTermWidth, prevTermHeight,
+                               term_size_changed, current_time, total_duration, total_time,
+                               frame_chars, false, ncursesHandler.is_paused, generate_ascii_func);
+            if (render_ctx.frame_measured &&
+                quality_governor.update(render_ctx.frame_costs, frame_scheduler.frame_duration(), clock_seconds())) {
+                apply_quality_level(render_ctx, quality_governor.current());
+                playback_stats.quality_level = quality_governor.current_level();
             }
+            av_frame_free(&pending.frame);
+            continue;
+        }
 
-            current_time = std::max(av_rescale_q(packet->pts, audio_ctx.stream->time_base, AV_TIME_BASE_Q) / AV_TIME_BASE, (int64_t)0);
-            render_audio_only_display(current_time, total_duration, total_time, term_size_changed, ncursesHandler.is_paused, has_visual);
+        // No fresh video frame: keep the overlay and the still picture (e.g. album cover) up to date
+        no_video_count += 1;
+        if (has_aural) {
+            update_heard_time(state, audio_ctx);
+        }
+        current_time = state.current_time;
+        if (no_video_count > NO_VIDEO_THRESHOLD && has_last_frame && has_aural) {
+            no_video_count -= 5;
+            const char *frame_chars =
+                ascii_char_sets[std::min(current_char_set_index, quality_governor.current().char_set_cap)].c_str();
+            render_video_frame(last_video_frame, render_ctx,
+                               termWidth, termHeight, prevTermWidth, prevTermHeight,
+                               term_size_changed, current_time, total_duration, total_time,
+                               frame_chars, force_refresh, ncursesHandler.is_paused, generate_ascii_func);
         }
-        av_packet_unref(packet);
+        render_audio_only_display(current_time, total_duration, total_time, term_size_changed, ncursesHandler.is_paused, has_visual);
+
+        bool video_done = !has_visual || video_eof_serial == state.serial;
+        bool audio_done = !has_aural || audio_ctx.eof_serial == state.serial;
+        if (audio_done && has_aural) {
+            audio_done = audio_ctx.queue.size() == 0;
+        }
+        if (video_done && audio_done && state.seek_target < 0) {
+            break;
+        }
+
+        TraceScope sleep_span("sleep");
+        sleep_until_seconds(loop_start + refresh_interval);
     }
 
+    // Stop the pipeline and wake up every stage blocked on a queue
+    state.stop = true;
+    video_ctx.packets.abort();
+    video_ctx.frames.abort();
+    audio_ctx.packets.abort();
+    audio_ctx.queue.close();
+    demuxer.join();
+    if (video_ctx.decoder.joinable()) {
+        video_ctx.decoder.join();
+    }
+    if (audio_ctx.decoder.joinable()) {
+        audio_ctx.decoder.join();
+    }
+    video_ctx.packets.flush(release_packet_entry);
+    video_ctx.frames.flush(release_frame_entry);
+    audio_ctx.packets.flush(release_packet_entry);
+    av_frame_free(&pending.frame);
+
     // Restore default Ctrl+C behavior
     signal(SIGINT, SIG_DFL);
 
     // Clean up
-    av_frame_free(&frame);
     av_frame_free(&last_video_frame);
-    av_packet_free(&packet);
     if (audio_device_id) {
         SDL_CloseAudioDevice(audio_device_id);
     }
+    bool trace_written = trace_stop(); // The audio callback is gone too now
     SDL_Quit();
     if (audio_ctx.swr_ctx) {
         swr_free(&audio_ctx.swr_ctx);
@@ -455,14 +859,14 @@ void play_media(const std::map<std::string, std::string> &params) {
     avformat_close_input(&format_ctx);
 
     // Clean up audio queue
-    SDL_DestroyMutex(audio_ctx.queue.mutex);
-    delete[] audio_ctx.queue.data;
+    audio_ctx.queue.destroy();
 
 
     if (!quit) {
         get_terminal_size(termWidth, termHeight);
         mvprintw(termHeight-1, 0, "\n");
         mvprintw(termHeight-1, 0, "Playback completed! Press any key to continue...");
+        ncursesHandler.stop_events();
         nodelay(stdscr, FALSE);
         getch();
         nodelay(stdscr, TRUE);
@@ -473,5 +877,26 @@ void play_media(const std::map<std::string, std::string> &params) {
         clear_screen();
         std::cout << "Playback interrupted!\n";
     }
-    
+
+    if (debug_mode) {
+        std::cout << "Video decoder: " << decoder_info << std::endl;
+        std::cout << "Dropped " << playback_stats.dropped_frames << " late video frames" << std::endl;
+        std::cout << "Skipped " << playback_stats.static_frames << " static video frames" << std::endl;
+        std::cout << "Quality: level " << quality_governor.current_level() << " of " << quality_governor.level_count() - 1
+                  << " at the end, " << quality_governor.changes() << " changes" << std::endl;
+        const JitterStats &jitter = frame_scheduler.jitter();
+        if (jitter.count() > 0) {
+            std::cout << "Frame jitter: mean " << jitter.mean() * 1000.0 << "ms, p50 " << jitter.percentile(0.5) * 1000.0
+                      << "ms, p99 " << jitter.percentile(0.99) * 1000.0 << "ms, max " << jitter.max() * 1000.0
+                      << "ms over " << jitter.count() << " frames" << std::endl;
+        }
+    }
+
+    if (!trace_path.empty()) {
+        if (trace_written) {
+            std::cout << "Trace written to " << trace_path << std::endl;
+        } else {
+            print_error("Error: Could not write the trace", trace_path);
+        }
+    }
 }
@@ -0,0 +1,123 @@
+//
+//  quality-governor.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/quality-governor.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+std::vector<QualityLevel> build_quality_ladder(const QualityLevel &top) {
+    std::vector<QualityLevel> ladder = {top};
+    auto step = [&ladder](auto change) {
+        QualityLevel next = ladder.back();
+        change(next);
+        if (!(next == ladder.back())) {
+            ladder.push_back(next);
+        }
+    };
+    step([](QualityLevel &q) {
+        if (q.color_mode == ColorMode::TrueColor) {
+            q.color_mode = ColorMode::Palette256;
+        }
+    });
+    step([](QualityLevel &q) {
+        if (q.glyph_mode == GlyphMode::Braille) {
+            q.glyph_mode = GlyphMode::HalfBlock;
+        } else if (q.glyph_mode == GlyphMode::Shape) {
+            q.glyph_mode = GlyphMode::Ascii;
+        }
+    });
+    step([](QualityLevel &q) { q.resolution = std::min(q.resolution, 75); });
+    step([](QualityLevel &q) { q.glyph_mode = GlyphMode::Ascii; });
+    step([](QualityLevel &q) { q.color_mode = ColorMode::None; });
+    step([](QualityLevel &q) { q.char_set_cap = 0; });
+    step([](QualityLevel &q) { q.resolution = std::min(q.resolution, 50); });
+    return ladder;
+}
+
+// Rough relative cost of each stage at a level, only used until the real ratios are measured
+static StageCosts estimate_costs(const QualityLevel &q) {
+    double area = q.resolution * q.resolution / 1e4;
+    double samples = glyph_mode_columns(q.glyph_mode) * glyph_mode_rows(q.glyph_mode);
+    bool colored = q.color_mode != ColorMode::None;
+    double color_bytes = q.color_mode == ColorMode::TrueColor ? 3.0 : colored ? 1.5 : 0.0;
+    StageCosts costs;
+    costs[STAGE_SCALE] = area * samples * (colored ? 3.0 : 1.0) + 4.0; // Plus reading the source frame
+    costs[STAGE_CONVERT] = area * (samples * (q.glyph_mode == GlyphMode::Shape ? 8.0 : 1.0) + (colored ? 2.0 : 0.0));
+    costs[STAGE_OUTPUT] = area * (1.0 + color_bytes) * (q.char_set_cap == INT_MAX ? 1.0 : 0.8);
+    return costs;
+}
+
+void QualityGovernor::init(const std::vector<QualityLevel> &levels) {
+    ladder = levels;
+    raise_ratios.assign(ladder.size(), StageCosts{});
+    for (size_t i = 0; i + 1 < ladder.size(); ++i) {
+        StageCosts upper = estimate_costs(ladder[i]), lower = estimate_costs(ladder[i + 1]);
+        for (int stage = 0; stage < RENDER_STAGE_COUNT; ++stage) {
+            raise_ratios[i][stage] = std::max(upper[stage] / lower[stage], 1.0);
+        }
+    }
+    level = 0;
+    left_level = -1;
+    frames = 0;
+    hold_time = GOVERNOR_HOLD_TIME;
+    change_count = 0;
+}
+
+void QualityGovernor::move_to(int next, double now) {
+    left_level = level;
+    left_costs = costs;
+    level = next;
+    frames = 0;
+    changed_at = now;
+    change_count++;
+}
+
+bool QualityGovernor::update(const StageCosts &frame, double interval, double now) {
+    if (ladder.size() < 2) {
+        return false;
+    }
+    for (int stage = 0; stage < RENDER_STAGE_COUNT; ++stage) {
+        costs[stage] = frames ? costs[stage] + GOVERNOR_SMOOTHING * (frame[stage] - costs[stage]) : frame[stage];
+    }
+    if (++frames < GOVERNOR_SETTLE_FRAMES) {
+        return false;
+    }
+    if (frames == GOVERNOR_SETTLE_FRAMES && left_level >= 0 && std::abs(left_level - level) == 1) {
+        // Both sides of the last move are known, which beats the guess
+        int upper = std::min(level, left_level);
+        const StageCosts &upper_costs = upper == level ? costs : left_costs;
+        const StageCosts &lower_costs = upper == level ? left_costs : costs;
+        for (int stage = 0; stage < RENDER_STAGE_COUNT; ++stage) {
+            if (lower_costs[stage] > 0.0) {
+                raise_ratios[upper][stage] = std::max(upper_costs[stage] / lower_costs[stage], 1.0);
+            }
+        }
+    }
+
+    double budget = interval * GOVERNOR_BUDGET_SHARE;
+    double total = std::accumulate(costs.begin(), costs.end(), 0.0);
+    if (total > budget && level + 1 < level_count()) {
+        // Undoing a recent step up means the prediction was off, wait longer before the next try
+        bool undo = left_level == level + 1 && now - changed_at < hold_time + GOVERNOR_HOLD_TIME;
+        hold_time = undo ? std::min(hold_time * 2.0, GOVERNOR_MAX_HOLD_TIME) : GOVERNOR_HOLD_TIME;
+        move_to(level + 1, now);
+        return true;
+    }
+    if (level > 0 && now - changed_at >= hold_time) {
+        double predicted = 0.0;
+        for (int stage = 0; stage < RENDER_STAGE_COUNT; ++stage) {
+            predicted += costs[stage] * raise_ratios[level - 1][stage];
+        }
+        if (predicted < budget * GOVERNOR_RAISE_SHARE) {
+            move_to(level - 1, now);
+            return true;
+        }
+    }
+    return false;
+}
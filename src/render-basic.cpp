@@ -0,0 +1,455 @@
+//
+//  render-basic.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2025/1/27.
+//
+
+#include "cmd-media-player/render-basic.hpp"
+
+// ANSI escape sequence to move the cursor to the top-left corner and clear the screen
+void move_cursor_to_top_left(bool clear_all) {
+    if (clear_all) {
+        clear();
+    }
+    mvprintw(0, 0, "");
+
+    // Original code
+
+    // printf("\033[H"); // Moves the cursor to (0, 0) and clears the screen
+    // if (clear)
+    //     printf("\033[2J");
+}
+
+void add_empty_lines_for(std::string &combined_output, int count) {
+    for (int i = 0; i < count; i++) {
+        combined_output += "\n"; // Return and clear the characters afterwords in this line
+        // combined_output += "\n\033[K"; // Return and clear the characters afterwords in this line
+    }
+}
+
+// Map every pixel value to its glyph once, instead of a strlen and a divide per pixel
+void build_glyph_lut(const char *asciiChars, std::array<char, 256> &lut) {
+    unsigned long asciiLength = strlen(asciiChars);
+    for (int pixel = 0; pixel < 256; ++pixel) {
+        lut[pixel] = asciiLength ? asciiChars[(pixel * asciiLength) / 256] : ' ';
+    }
+}
+
+// The table of the charset in use, only rebuilt when the charset changes
+const GlyphTable &glyph_table_for(const char *asciiChars) {
+    thread_local std::string cached_chars;
+    thread_local GlyphTable table = {};
+    thread_local bool built = false;
+    if (!built || cached_chars != asciiChars) {
+        std::array<char, 256> lut;
+        cached_chars = asciiChars;
+        build_glyph_lut(asciiChars, lut);
+        build_glyph_table(lut, table);
+        built = true;
+    }
+    return table;
+}
+
+void map_pixels_to_ascii(const cv::Mat &image, int pre_space, const GlyphTable &table,
+                         std::string &asciiImage, PixelHistogram *histogram) {
+    // Every row is the left padding, one glyph per pixel and a line break when padded
+    const size_t row_length = pre_space + image.cols + (pre_space ? 1 : 0);
+    size_t offset = asciiImage.size();
+    asciiImage.resize(offset + row_length * image.rows);
+    char *base = asciiImage.data() + offset;
+
+    // Rows have a fixed length, so bands of rows fill disjoint parts of the buffer.
+    // Each band counts into its own histogram while the row is still in cache.
+    int bands = row_band_count(image.rows, static_cast<int64_t>(image.total()));
+    std::vector<PixelHistogram> band_histograms(histogram ? bands : 0, PixelHistogram{});
+    for_each_row_band(image.rows, bands, [&](int band, int first_row, int end_row) {
+        char *out = base + row_length * first_row;
+        for (int i = first_row; i < end_row; ++i) {
+            out = std::fill_n(out, pre_space, ' ');
+            map_row_to_glyphs(image.ptr<uchar>(i), image.cols, table, out);
+            if (histogram) {
+                count_pixels(image.ptr<uchar>(i), image.cols, band_histograms[band]);
+            }
+            out += image.cols;
+            if (pre_space) {
+                *out++ = '\n'; // Return and clear the characters afterwords in this line
+            }
+        }
+    });
+    for (const PixelHistogram &band_histogram : band_histograms) {
+        for (int value = 0; value < 256; ++value) {
+            (*histogram)[value] += band_histogram[value];
+        }
+    }
+}
+
+void image_to_ascii_dy_contrast(const cv::Mat &image,
+                                int pre_space,
+                                const char *asciiChars,
+                                std::string &asciiImage) {
+    // Step 1: Find the maximum and the minimum depth of the pixels in the image,
+    // per band first, then over the bands
+    int bands = row_band_count(image.rows, static_cast<int64_t>(image.total()));
+    std::vector<uint8_t> band_min(bands, 255), band_max(bands, 0);
+    for_each_row_band(image.rows, bands, [&](int band, int first_row, int end_row) {
+        for (int i = first_row; i < end_row; ++i) {
+            min_max_pixels(image.ptr<uchar>(i), image.cols, band_min[band], band_max[band]);
+        }
+    });
+    uint8_t min_pixel_value = *std::min_element(band_min.begin(), band_min.end());
+    uint8_t max_pixel_value = *std::max_element(band_max.begin(), band_max.end());
+    const int min_pixel = min_pixel_value;
+    const int range = max_pixel_value - min_pixel;
+
+    // Step 2: Fold the stretch to 0-255 into this frame's table, so each pixel is a single lookup
+    const GlyphTable &base_table = glyph_table_for(asciiChars);
+    std::array<char, 256> lut;
+    for (int pixel = 0; pixel < 256; ++pixel) {
+        int scaled_pixel = range > 0 ? std::clamp((pixel - min_pixel) * 255 / range, 0, 255) : pixel;
+        lut[pixel] = base_table.lut[scaled_pixel];
+    }
+    GlyphTable table;
+    build_glyph_table(lut, table);
+
+    // Step 3: Map the pixels to the ASCII character set
+    map_pixels_to_ascii(image, pre_space, table, asciiImage);
+}
+
+void image_to_ascii(const cv::Mat &image, int pre_space,
+                    const char *asciiChars, std::string &asciiImage) {
+    map_pixels_to_ascii(image, pre_space, glyph_table_for(asciiChars), asciiImage);
+}
+
+void generate_ascii_image(const cv::Mat &image,
+                          int pre_space,
+                          const char *asciiChars,
+                          std::string &asciiImage,
+                          void (*ascii_func)(const cv::Mat &, int, const char *, std::string &)) {
+    // Call the pointer to the function to switch between generating methods
+    ascii_func(image, pre_space, asciiChars, asciiImage);
+}
+
+std::string create_progress_bar(double progress, int width) {
+    int filled = static_cast<int>(progress * (width));
+    std::string bar = std::string(filled, '+') + std::string(width - filled, '-');
+    return bar;
+}
+
+std::string format_playback_stats(const PlaybackStats &stats) {
+    char line[128];
+    int length = snprintf(line, sizeof(line), "fps %.1f | dropped %lld | static %lld", stats.fps,
+                          static_cast<long long>(stats.dropped_frames), static_cast<long long>(stats.static_frames));
+    if (stats.quality_level > 0) {
+        length += snprintf(line + length, sizeof(line) - length, " | quality -%d", stats.quality_level);
+    }
+    if (!std::isnan(stats.av_offset)) {
+        length += snprintf(line + length, sizeof(line) - length, " | A/V %+.0fms", stats.av_offset * 1000.0);
+    }
+    if (!std::isnan(stats.audio_fill)) {
+        snprintf(line + length, sizeof(line) - length, " | audio queue %.0f%%", stats.audio_fill * 100.0);
+    }
+    return line;
+}
+
+void render_playback_overlay(int termHeight, int termWidth, int volume, int64_t total_duration, std::string total_time, int64_t current_time, bool &is_paused, bool force_refresh) {
+    if (current_time < 0 || current_time > total_duration) {
+        refresh();
+        return;
+    }
+    std::string time_played = format_time(current_time);
+    int progress_width = termWidth - (int)time_played.length() - (int)total_time.length() - 2; // 2 for /
+    double progress = (total_duration != 0 && !std::isnan(current_time) && !std::isnan(total_duration)) ? std::clamp(static_cast<double>(current_time) / total_duration, 0.0, 1.0) : 1.0;
+    std::string progress_bar = create_progress_bar(progress, progress_width);
+    std::string progress_output = time_played + "\\" + progress_bar + "/" + total_time + "\n";
+
+    if (force_refresh) {
+        // mvprintw(termHeight - 2, 0, "\n\n");
+        clear();
+    }
+
+    mvprintw(termHeight - 2, 0, "%s", progress_output.c_str());
+    if (playback_stats.enabled) {
+        mvprintw(termHeight - 1, 0, "%s", format_playback_stats(playback_stats).c_str());
+        clrtoeol();
+    } else {
+        mvprintw(termHeight - 1, 0, "Press SPACE to pause/resume, ESC/Ctrl+C to quit");
+    }
+    mvprintw(termHeight - 1, termWidth - 13, "Vol: %d%%", volume * 100 / SDL_MIX_MAXVOLUME);
+    mvprintw(termHeight - 1, termWidth - 2, is_paused ? "||" : "|>");
+    // printw("Frame time: %d ms, Frame delay: %d ms", frame_time, frame_delay);
+    refresh();
+}
+
+void list_audio_devices() {
+    int count = SDL_GetNumAudioDevices(0); // 0 for playback devices
+    std::cout << "Available audio devices:" << std::endl;
+    for (int i = 0; i < count; ++i) {
+        std::cout << i << ": " << SDL_GetAudioDeviceName(i, 0) << std::endl;
+    }
+}
+
+int select_audio_device() {
+    list_audio_devices();
+    int selection;
+    std::cout << "Enter the number of the audio device you want to use: ";
+    std::cin >> selection;
+    return selection;
+}
+
+void print_audio_stream_info(AVStream *audio_stream, AVCodecContext *audio_codec_ctx) {
+    std::cout << "\n====== Audio Stream Information ======\n";
+    std::cout << "Codec: " << avcodec_get_name(audio_codec_ctx->codec_id) << std::endl;
+    std::cout << "Bitrate: " << audio_codec_ctx->bit_rate << " bps" << std::endl;
+    std::cout << "Sample Rate: " << audio_codec_ctx->sample_rate << " Hz" << std::endl;
+    std::cout << "Channels: " << audio_codec_ctx->ch_layout.nb_channels << std::endl;
+    std::cout << "Sample Format: " << av_get_sample_fmt_name(audio_codec_ctx->sample_fmt) << std::endl;
+    std::cout << "Frame Size: " << audio_codec_ctx->frame_size << std::endl;
+    std::cout << "Timebase: " << audio_stream->time_base.num << "/" << audio_stream->time_base.den << std::endl;
+
+    // Print channel layout
+    char channel_layout[64];
+    av_channel_layout_describe(&audio_codec_ctx->ch_layout, channel_layout, sizeof(channel_layout));
+    std::cout << "Channel Layout: " << channel_layout << std::endl;
+
+    // Print codec parameters
+    std::cout << "Codec Parameters:" << std::endl;
+    std::cout << "  Format: " << audio_stream->codecpar->format << std::endl;
+    std::cout << "  Codec Type: " << av_get_media_type_string(audio_stream->codecpar->codec_type) << std::endl;
+    std::cout << "  Codec ID: " << audio_stream->codecpar->codec_id << std::endl;
+    std::cout << "  Codec Tag: 0x" << std::hex << std::setw(8) << std::setfill('0') << audio_stream->codecpar->codec_tag << std::dec << std::endl;
+
+    std::cout << "======================================\n\n";
+}
+
+void audio_callback(void *userdata, Uint8 *stream, int len) {
+    thread_local bool trace_named = false;
+    if (!trace_named && trace_enabled()) {
+        trace_thread_name("audio callback");
+        trace_named = true;
+    }
+    TraceScope callback_span("audio callback");
+    auto audio_ctx = static_cast<AudioContext *>(userdata);
+    SDL_memset(stream, 0, len);
+
+    // Never blocks: whatever is queued gets mixed in, at most two spans, the rest stays silent
+    uint64_t consumed = audio_ctx->queue.pop(len, [stream](const uint8_t *span, uint64_t span_len, uint64_t offset) {
+        // Apply volume control with timing check
+        SDL_MixAudioFormat(stream + offset, span, AUDIO_S16SYS, static_cast<Uint32>(span_len), volume);
+    });
+
+    // Advance the master clock by what the device actually got
+    uint64_t read_end = audio_ctx->queue.read_pos.load(std::memory_order_relaxed);
+    audio_ctx->clock.on_consume(read_end - consumed, consumed, len);
+    if (trace_enabled()) {
+        trace_counter("audio queue bytes", static_cast<double>(audio_ctx->queue.size()));
+    }
+}
+
+FrameLayout layout_frame(const AVFrame *frame, int termWidth, int termHeight, int percent) {
+    // Fit the frame in a box of `percent` of the terminal, then centre the box
+    int boxWidth = std::max(termWidth * percent / 100, 1);
+    int boxHeight = std::max((termHeight - 2) * percent / 100, 1) + 2;
+    FrameLayout layout;
+    layout.width = boxWidth;
+    layout.height = (frame->height * layout.width) / frame->width / 2;
+    layout.pre_space = 0;
+    layout.pre_lines = (boxHeight - layout.height - 2) / 2;
+
+    if (layout.height > boxHeight - 2) {
+        layout.height = boxHeight - 2;
+        layout.width = (frame->width * layout.height * 2) / frame->height;
+        layout.pre_space = (boxWidth - layout.width) / 2;
+        layout.pre_lines = 0;
+    }
+    layout.pre_space += (termWidth - boxWidth) / 2;
+    layout.pre_lines += (termHeight - boxHeight) / 2;
+    return layout;
+}
+
+void apply_quality_level(RenderContext &render_ctx, const QualityLevel &quality) {
+    render_ctx.glyph_mode = quality.glyph_mode;
+    render_ctx.color_mode = quality.color_mode;
+    render_ctx.resolution = quality.resolution;
+    // A colour depth change leaves the scaled image as it was, so the next frame must not pass
+    // for static. The diff needs no help, the colour keys, encoding or size of the cells change.
+    render_ctx.static_frames.invalidate();
+}
+
+void compose_screen(const cv::Mat &image, const FrameLayout &layout, int termHeight,
+                    const char *frame_chars, const AsciiConverter &generate_ascii_func,
+                    std::string &screen) {
+    screen.clear();
+    add_empty_lines_for(screen, layout.pre_lines);
+    generate_ascii_func(image, layout.pre_space, frame_chars, screen);
+    add_empty_lines_for(screen, termHeight - layout.height - layout.pre_lines);
+}
+
+const cv::Mat &scale_frame_for_cells(RenderContext &render_ctx, const AVFrame *frame, const FrameLayout &layout) {
+    int width = layout.width * glyph_mode_columns(render_ctx.glyph_mode);
+    int height = layout.height * glyph_mode_rows(render_ctx.glyph_mode);
+    return render_ctx.color_mode != ColorMode::None ? render_ctx.scaler.scale_rgb(frame, width, height)
+                                                    : render_ctx.scaler.scale(frame, width, height);
+}
+
+void load_frame_cells(RenderContext &render_ctx, const cv::Mat &image, const FrameLayout &layout,
+                      int termWidth, int termHeight, const char *frame_chars,
+                      const AsciiConverter &generate_ascii_func) {
+    const bool colored = render_ctx.color_mode != ColorMode::None && !image.empty();
+    if (render_ctx.glyph_mode == GlyphMode::Ascii) {
+        // In colour the glyphs come from the luma and the colours from the RGB image
+        const cv::Mat *gray = &image;
+        if (colored) {
+            cv::cvtColor(image, render_ctx.color_gray, cv::COLOR_RGB2GRAY);
+            gray = &render_ctx.color_gray;
+        }
+        compose_screen(*gray, layout, termHeight, frame_chars, generate_ascii_func, render_ctx.frame_output);
+        render_ctx.diff.load(render_ctx.frame_output, termWidth, termHeight - 2);
+        if (colored) {
+            render_ctx.diff.load_colors(image.data, image.step, image.cols, image.rows,
+                                        layout.pre_lines, layout.pre_space, render_ctx.color_mode);
+        }
+        return;
+    }
+
+    // The other modes write straight into the grid, the frame placed like the ASCII one
+    const GlyphEncoding *encoding = nullptr; // Shapes are ASCII
+    if (render_ctx.glyph_mode == GlyphMode::HalfBlock) {
+        encoding = &half_block_encoding();
+    } else if (render_ctx.glyph_mode == GlyphMode::Braille) {
+        encoding = &braille_encoding();
+    }
+    char *cells = render_ctx.diff.load_codes(termWidth, termHeight - 2, encoding);
+    ColorKey *colors = colored ? render_ctx.diff.load_color_keys() : nullptr;
+    int top = std::max(layout.pre_lines, 0);
+    if (image.empty() || top + layout.height > termHeight - 2 || layout.pre_space + layout.width > termWidth) {
+        return;
+    }
+    size_t offset = static_cast<size_t>(top) * termWidth + layout.pre_space;
+    ColorKey *frame_colors = colors ? colors + offset : nullptr;
+    switch (render_ctx.glyph_mode) {
+    case GlyphMode::HalfBlock:
+        map_half_blocks(image, render_ctx.color_mode, cells + offset, frame_colors, termWidth);
+        break;
+    case GlyphMode::Braille:
+        map_braille(image, render_ctx.color_mode, cells + offset, frame_colors, termWidth);
+        break;
+    default:
+        map_shape_glyphs(image, render_ctx.color_mode, glyph_table_for(frame_chars), cells + offset, frame_colors,
+                         termWidth);
+        break;
+    }
+}
+
+void render_video_frame(AVFrame *frame, RenderContext &render_ctx,
+                        int termWidth, int termHeight,
+                        int &prevTermWidth, int &prevTermHeight, bool &term_size_changed,
+                        int64_t current_time, int64_t total_duration, std::string total_time,
+                        const char *frame_chars,
+                        bool force_refresh, bool &is_paused,
+                        const AsciiConverter &generate_ascii_func) {
+    // Update terminal size status
+    get_terminal_size(termWidth, termHeight);
+    if (termWidth != prevTermWidth || termHeight != prevTermHeight) {
+        prevTermWidth = termWidth;
+        prevTermHeight = termHeight;
+        term_size_changed = true;
+    } else {
+        term_size_changed = false;
+    }
+
+    // Convert and shrink to the cell grid in a single pass, then build the whole screen in the reused buffer.
+    // The stages are timed even when not traced, the quality governor runs on them.
+    FrameLayout layout = layout_frame(frame, termWidth, termHeight, render_ctx.resolution);
+    double scale_start = clock_seconds();
+    const cv::Mat &image = scale_frame_for_cells(render_ctx, frame, layout);
+    double scaled = clock_seconds();
+    trace_span("scale", scale_start);
+
+    // Only hand the cells that changed since the last frame to the terminal
+    bool full_repaint = term_size_changed || force_refresh;
+    if (full_repaint) {
+        render_ctx.diff.invalidate();
+        render_ctx.static_frames.invalidate();
+    }
+    render_ctx.frame_measured = false;
+    if (render_ctx.static_frames.unchanged(image, frame_chars)) {
+        // Same picture as on screen, only the overlay moves on
+        playback_stats.static_frames++;
+        render_playback_overlay(termHeight, termWidth, volume, total_duration, total_time, current_time, is_paused, false);
+        return;
+    }
+    double convert_start = clock_seconds();
+    load_frame_cells(render_ctx, image, layout, termWidth, termHeight, frame_chars, generate_ascii_func);
+    double converted = clock_seconds();
+    trace_span("ascii", convert_start);
+
+    if (render_ctx.ansi_output) {
+        // Let ncurses finish clearing first, otherwise its next refresh wipes the frame
+        if (full_repaint) {
+            move_cursor_to_top_left(true);
+            refresh();
+        }
+        render_ctx.ansi_writer.write_frame(render_ctx.diff);
+    } else {
+        move_cursor_to_top_left(full_repaint);
+        render_ctx.diff.for_each_change([](int row, int col, const char *text, const ColorKey *, int length) {
+            mvaddnstr(row, col, text, length);
+        });
+    }
+    render_playback_overlay(termHeight, termWidth, volume, total_duration, total_time, current_time, is_paused, false);
+    trace_span("write", converted);
+    render_ctx.frame_costs = {scaled - scale_start, converted - scaled, clock_seconds() - converted};
+    render_ctx.frame_measured = true;
+}
+
+void process_audio_frame(AVFrame *frame, AudioContext &audio_ctx, const std::atomic<bool> &quit) {
+    int out_samples = (int)av_rescale_rnd(swr_get_delay(audio_ctx.swr_ctx, audio_ctx.codec_ctx->sample_rate) + frame->nb_samples,
+                                          audio_ctx.spec.freq, audio_ctx.codec_ctx->sample_rate, AV_ROUND_UP);
+    uint8_t *out_buffer;
+    av_samples_alloc(&out_buffer, nullptr, audio_ctx.spec.channels, out_samples, AV_SAMPLE_FMT_S16, 0);
+
+    int samples_out = swr_convert(audio_ctx.swr_ctx, &out_buffer, out_samples,
+                                  (const uint8_t **)frame->data, frame->nb_samples);
+
+    if (samples_out > 0) {
+        int buffer_size = av_samples_get_buffer_size(nullptr, audio_ctx.spec.channels,
+                                                     samples_out, AV_SAMPLE_FMT_S16, 1);
+
+        // Sleeps until the audio callback has drained the queue, instead of polling it
+        if (audio_ctx.queue.wait_for_space(buffer_size, quit)) {
+            uint64_t pos = audio_ctx.queue.write_pos.load(std::memory_order_relaxed);
+            audio_ctx.clock.on_push(pos, buffer_size, frame_pts_seconds(frame, audio_ctx.stream));
+            audio_ctx.queue.push(out_buffer, buffer_size);
+        }
+    }
+
+    av_freep(&out_buffer);
+}
+
+// Presentation time of a decoded frame in seconds, NAN if it carries no timestamp
+double frame_pts_seconds(const AVFrame *frame, const AVStream *stream) {
+    int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+    if (pts == AV_NOPTS_VALUE) {
+        return NAN;
+    }
+    return pts * av_q2d(stream->time_base);
+}
+
+// Presentation time of a decoded frame in whole seconds, or `fallback` if it carries no timestamp
+int64_t frame_time_seconds(const AVFrame *frame, const AVStream *stream, int64_t fallback) {
+    int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+    if (pts == AV_NOPTS_VALUE) {
+        return fallback;
+    }
+    return std::max(av_rescale_q(pts, stream->time_base, AV_TIME_BASE_Q) / AV_TIME_BASE, (int64_t)0);
+}
+
+void render_audio_only_display(int64_t current_time, int64_t total_duration,
+                               std::string total_time, bool term_size_changed,
+                               bool &is_paused, bool has_v) {
+    int termWidth, termHeight;
+    get_terminal_size(termWidth, termHeight);
+    // move_cursor_to_top_left(term_size_changed);
+    render_playback_overlay(termHeight, termWidth, volume, total_duration, total_time, current_time, is_paused, term_size_changed && !has_v);
+}
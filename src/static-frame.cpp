@@ -0,0 +1,51 @@
+//
+//  static-frame.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/static-frame.hpp"
+
+#include <cstdlib>
+
+#include "cmd-media-player/glyph-kernels.hpp"
+
+double parse_static_threshold(const std::string &value) {
+    if (value == "off") {
+        return -1.0;
+    }
+    char *end = nullptr;
+    double threshold = strtod(value.c_str(), &end);
+    if (end == value.c_str() || threshold < 0.0) {
+        return STATIC_FRAME_DEFAULT_THRESHOLD;
+    }
+    return threshold;
+}
+
+bool StaticFrameDetector::unchanged(const cv::Mat &image, const char *frame_chars) {
+    if (!enabled() || image.empty()) {
+        valid = false;
+        return false;
+    }
+    const int row_bytes = image.cols * static_cast<int>(image.elemSize());
+    bool same = valid && frame_chars == reference_chars && image.rows == reference.rows &&
+                image.cols == reference.cols && image.type() == reference.type();
+    if (same) {
+        // Per row rather than over the frame, so a small change such as a moving
+        // pointer is not averaged away. Stops at the first row that differs.
+        const uint64_t budget = static_cast<uint64_t>(threshold * row_bytes);
+        for (int y = 0; y < image.rows; ++y) {
+            if (sum_abs_diff(image.ptr<uint8_t>(y), reference.ptr<uint8_t>(y), row_bytes) > budget) {
+                same = false;
+                break;
+            }
+        }
+    }
+    if (!same) {
+        image.copyTo(reference);
+        reference_chars = frame_chars;
+        valid = true;
+    }
+    return same;
+}
@@ -0,0 +1,45 @@
+//
+//  terminal-output.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/terminal-output.hpp"
+
+#include <cerrno>
+#include <unistd.h>
+
+#define SYNC_UPDATE_BEGIN "\033[?2026h\0337" // Begin synchronized update, save cursor
+#define SYNC_UPDATE_END "\0338\033[?2026l"   // Restore cursor, end synchronized update
+
+bool write_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+AnsiFrameWriter::AnsiFrameWriter(int fd) : fd(fd) {}
+
+bool AnsiFrameWriter::write_frame(FrameDiff &diff) {
+    buffer.clear();
+    buffer += SYNC_UPDATE_BEGIN;
+    size_t header_size = buffer.size();
+    diff.append_changes_as_ansi(buffer);
+    if (buffer.size() == header_size) {
+        last_size = 0;
+        return true; // Nothing changed
+    }
+    buffer += SYNC_UPDATE_END;
+    last_size = buffer.size();
+    return write_all(fd, buffer.data(), buffer.size());
+}
@@ -0,0 +1,119 @@
+//
+//  trace.cpp
+//  CMD-Media-Player
+//
+//  Created by Robert He on 2026/10/16.
+//
+
+#include "cmd-media-player/trace.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct TraceEvent {
+    const char *name;
+    double time;
+    double value; // Duration of a span, or the counter value
+    bool counter;
+};
+
+struct ThreadTrace {
+    int tid;
+    std::string name;
+    std::vector<TraceEvent> events;
+};
+
+std::atomic<bool> trace_active = false;
+
+static std::mutex registry_mutex;
+static std::vector<std::unique_ptr<ThreadTrace>> registry; // Buffers of the current recording
+static std::atomic<uint64_t> session{0};                  // Bumped per recording, drops stale thread buffers
+static std::string trace_path;
+static double trace_origin = 0.0;
+
+// The calling thread's buffer, registered on first use in each recording
+static ThreadTrace &thread_trace() {
+    thread_local ThreadTrace *local = nullptr;
+    thread_local uint64_t local_session = 0;
+    uint64_t current = session.load(std::memory_order_acquire);
+    if (!local || local_session != current) {
+        auto buffer = std::make_unique<ThreadTrace>();
+        buffer->events.reserve(TRACE_RESERVE_EVENTS);
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        buffer->tid = static_cast<int>(registry.size()) + 1;
+        local = buffer.get();
+        local_session = current;
+        registry.push_back(std::move(buffer));
+    }
+    return *local;
+}
+
+void trace_start(const std::string &path) {
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.clear();
+        trace_path = path;
+        trace_origin = clock_seconds();
+    }
+    session++;
+    trace_active = true;
+}
+
+void trace_thread_name(const char *name) {
+    if (trace_enabled()) {
+        thread_trace().name = name;
+    }
+}
+
+void trace_span(const char *name, double start) {
+    if (start == 0.0 || !trace_enabled()) {
+        return;
+    }
+    double end = clock_seconds();
+    thread_trace().events.push_back({name, start, end - start, false});
+}
+
+void trace_counter(const char *name, double value) {
+    if (trace_enabled()) {
+        thread_trace().events.push_back({name, clock_seconds(), value, true});
+    }
+}
+
+bool trace_stop() {
+    if (!trace_active.exchange(false)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    FILE *file = fopen(trace_path.c_str(), "w");
+    if (!file) {
+        registry.clear();
+        return false;
+    }
+
+    // Timestamps are in microseconds since the recording started
+    const char *separator = "";
+    fprintf(file, "{\"traceEvents\":[");
+    for (const auto &thread : registry) {
+        if (!thread->name.empty()) {
+            fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    separator, thread->tid, thread->name.c_str());
+            separator = ",";
+        }
+        for (const TraceEvent &event : thread->events) {
+            double ts = (event.time - trace_origin) * 1e6;
+            if (event.counter) {
+                fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%g}}",
+                        separator, event.name, ts, thread->tid, event.value);
+            } else {
+                fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                        separator, event.name, ts, event.value * 1e6, thread->tid);
+            }
+            separator = ",";
+        }
+    }
+    fprintf(file, "\n]}\n");
+    registry.clear();
+    return fclose(file) == 0;
+}